@@ -17,6 +17,8 @@ typedef struct ANI_PlayingAnimation
 	Uint64 start_time;
 	ANI_Animation* animation;
 	SDL_Texture* texture;
+	TXT_Atlas* atlas;
+	char* text;
 	SDL_FPoint position;
 	void (*callback)(void* user_data);
 	void* user_data;
@@ -221,7 +223,22 @@ bool ANI_PlayAnimation(ANI_Animation* animation, SDL_Texture* texture, SDL_FPoin
 	return ANI_PlayAnimationWithCallback(animation, texture, position, time, NULL, NULL);
 }
 
-bool ANI_RenderAnimation(SDL_Renderer* renderer, ANI_PlayingAnimation* animation, Uint64 time)
+bool ANI_PlayTextAnimationWithCallback(ANI_Animation* animation, TXT_Atlas* atlas, const char* text, SDL_FPoint position, Uint64 time, void (*callback)(void* user_data), void* user_data)
+{
+	if (!ANI_PlayAnimationWithCallback(animation, NULL, position, time, callback, user_data)) { return false; }
+	
+	ANI_animations_tail->atlas = atlas;
+	ANI_animations_tail->text = SDL_strdup(text);
+	
+	return true;
+}
+
+bool ANI_PlayTextAnimation(ANI_Animation* animation, TXT_Atlas* atlas, const char* text, SDL_FPoint position, Uint64 time)
+{
+	return ANI_PlayTextAnimationWithCallback(animation, atlas, text, position, time, NULL, NULL);
+}
+
+bool ANI_RenderAnimation(RND_Queue* queue, int layer, ANI_PlayingAnimation* animation, Uint64 time)
 {
 	while ((animation->animation->next) && (animation->animation->next->time < (time - animation->start_time)))
 	{
@@ -238,21 +255,28 @@ bool ANI_RenderAnimation(SDL_Renderer* renderer, ANI_PlayingAnimation* animation
 	SDL_FPoint scale = {current->scale.x + (next->scale.x - current->scale.x) * coeff, current->scale.y + (next->scale.y - current->scale.y) * coeff};
 	float alpha = current->alpha + (next->alpha - current->alpha) * coeff;
 	float rotation = current->rotation + (next->rotation - current->rotation) * coeff;
+	
+	if (animation->text)
+	{
+		TXT_AddText(animation->atlas, queue, layer, animation->text, position, scale, rotation, (SDL_Color){255, 255, 255, (Uint8)(alpha * 255)});
+		return true;
+	}
+	
 	SDL_FRect rect = {position.x - animation->texture->w * scale.x / 2, position.y - animation->texture->h * scale.y / 2, animation->texture->w * scale.x, animation->texture->h * scale.y};
 	
-	SDL_SetTextureAlphaMod(animation->texture, alpha * 255);
-	SDL_RenderTextureRotated(renderer, animation->texture, NULL, &rect, rotation, NULL, SDL_FLIP_NONE);
+	SDL_FRect uv = {0.0f, 0.0f, 1.0f, 1.0f};
+	RND_AddRotatedQuad(queue, layer, animation->texture, &rect, &uv, position, rotation, (SDL_FColor){1.0f, 1.0f, 1.0f, alpha});
 
 	return true;
 }
 
-bool ANI_RenderAnimations(SDL_Renderer* renderer, Uint64 time)
+bool ANI_RenderAnimations(RND_Queue* queue, int layer, Uint64 time)
 {
 	ANI_PlayingAnimation* prev = NULL;
 	ANI_PlayingAnimation* iterator = ANI_animations_head;
 	while (iterator)
 	{
-		if (!ANI_RenderAnimation(renderer, iterator, time))
+		if (!ANI_RenderAnimation(queue, layer, iterator, time))
 		{
 			if (iterator->callback) { iterator->callback(iterator->user_data); }
 			ANI_PlayingAnimation* next = iterator->next;
@@ -270,6 +294,7 @@ bool ANI_RenderAnimations(SDL_Renderer* renderer, Uint64 time)
 				ANI_animations_tail = prev;
 			}
 			
+			SDL_free(iterator->text);
 			SDL_free(iterator);
 			iterator = next;
 		}
@@ -288,6 +313,7 @@ void ANI_ClearAnimations()
 	while (iterator)
 	{
 		ANI_PlayingAnimation* next = iterator->next;
+		SDL_free(iterator->text);
 		SDL_free(iterator);
 		iterator = next;
 	}
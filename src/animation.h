@@ -1,5 +1,6 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include "text.h"
 
 typedef struct ANI_Animation ANI_Animation;
 
@@ -13,6 +14,10 @@ bool ANI_PlayAnimation(ANI_Animation* animation, SDL_Texture* texture, SDL_FPoin
 
 bool ANI_PlayAnimationWithCallback(ANI_Animation* animation, SDL_Texture* texture, SDL_FPoint position, Uint64 time, void (*callback)(void* user_data), void* user_data);
 
-bool ANI_RenderAnimations(SDL_Renderer* renderer, Uint64 time);
+bool ANI_PlayTextAnimation(ANI_Animation* animation, TXT_Atlas* atlas, const char* text, SDL_FPoint position, Uint64 time);
+
+bool ANI_PlayTextAnimationWithCallback(ANI_Animation* animation, TXT_Atlas* atlas, const char* text, SDL_FPoint position, Uint64 time, void (*callback)(void* user_data), void* user_data);
+
+bool ANI_RenderAnimations(RND_Queue* queue, int layer, Uint64 time);
 
 void ANI_ClearAnimations();
@@ -0,0 +1,177 @@
+#include "boxes.h"
+#include <SDL3/SDL_bits.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_intrin.h>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+#define BOX_MIN_CAPACITY 64
+
+typedef int (*BOX_Kernel)(const BOX_Boxes* boxes, const Sint32* query, int first, int last);
+
+static BOX_Kernel BOX_kernel = NULL;
+
+void BOX_SetBox(BOX_Boxes* boxes, int index, const SDL_Rect* rect)
+{
+    if ((rect->w < 0) || (rect->h < 0))
+    {
+        BOX_SetEmptyBox(boxes, index);
+        return;
+    }
+
+    boxes->min_x[index] = rect->x;
+    boxes->min_y[index] = rect->y;
+    boxes->max_x[index] = rect->x + rect->w;
+    boxes->max_y[index] = rect->y + rect->h;
+}
+
+void BOX_SetEmptyBox(BOX_Boxes* boxes, int index)
+{
+    boxes->min_x[index] = SDL_MAX_SINT32;
+    boxes->min_y[index] = SDL_MAX_SINT32;
+    boxes->max_x[index] = SDL_MIN_SINT32;
+    boxes->max_y[index] = SDL_MIN_SINT32;
+}
+
+static bool BOX_Hit(const BOX_Boxes* boxes, int index, const Sint32* query)
+{
+    return (boxes->min_x[index] <= query[2]) && (query[0] <= boxes->max_x[index]) &&
+           (boxes->min_y[index] <= query[3]) && (query[1] <= boxes->max_y[index]);
+}
+
+static int BOX_FindIntersectionScalar(const BOX_Boxes* boxes, const Sint32* query, int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        if (BOX_Hit(boxes, i, query)) { return i; }
+    }
+
+    return -1;
+}
+
+static int BOX_GetFirstBit(Uint32 mask)
+{
+    return SDL_MostSignificantBitIndex32(mask & (~mask + 1));
+}
+
+#ifdef SDL_AVX2_INTRINSICS
+SDL_TARGETING("avx2") static int BOX_FindIntersectionAVX2(const BOX_Boxes* boxes, const Sint32* query, int first, int last)
+{
+    __m256i query_min_x = _mm256_set1_epi32(query[0]);
+    __m256i query_min_y = _mm256_set1_epi32(query[1]);
+    __m256i query_max_x = _mm256_set1_epi32(query[2]);
+    __m256i query_max_y = _mm256_set1_epi32(query[3]);
+
+    int i = first;
+    for (; i + 8 <= last; i += 8)
+    {
+        __m256i misses_x = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(boxes->min_x + i)), query_max_x), _mm256_cmpgt_epi32(query_min_x, _mm256_loadu_si256((const __m256i*)(boxes->max_x + i))));
+        __m256i misses_y = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(boxes->min_y + i)), query_max_y), _mm256_cmpgt_epi32(query_min_y, _mm256_loadu_si256((const __m256i*)(boxes->max_y + i))));
+
+        Uint32 mask = ~(Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(misses_x, misses_y))) & 0xFF;
+        if (mask) { return i + BOX_GetFirstBit(mask); }
+    }
+    _mm256_zeroupper();
+
+    return BOX_FindIntersectionScalar(boxes, query, i, last);
+}
+#endif
+
+#ifdef SDL_SSE2_INTRINSICS
+SDL_TARGETING("sse2") static int BOX_FindIntersectionSSE2(const BOX_Boxes* boxes, const Sint32* query, int first, int last)
+{
+    __m128i query_min_x = _mm_set1_epi32(query[0]);
+    __m128i query_min_y = _mm_set1_epi32(query[1]);
+    __m128i query_max_x = _mm_set1_epi32(query[2]);
+    __m128i query_max_y = _mm_set1_epi32(query[3]);
+
+    int i = first;
+    for (; i + 4 <= last; i += 4)
+    {
+        __m128i misses_x = _mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(boxes->min_x + i)), query_max_x), _mm_cmpgt_epi32(query_min_x, _mm_loadu_si128((const __m128i*)(boxes->max_x + i))));
+        __m128i misses_y = _mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(boxes->min_y + i)), query_max_y), _mm_cmpgt_epi32(query_min_y, _mm_loadu_si128((const __m128i*)(boxes->max_y + i))));
+
+        Uint32 mask = ~(Uint32)_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(misses_x, misses_y))) & 0xF;
+        if (mask) { return i + BOX_GetFirstBit(mask); }
+    }
+
+    return BOX_FindIntersectionScalar(boxes, query, i, last);
+}
+#endif
+
+#ifdef __wasm_simd128__
+static int BOX_FindIntersectionSIMD128(const BOX_Boxes* boxes, const Sint32* query, int first, int last)
+{
+    v128_t query_min_x = wasm_i32x4_splat(query[0]);
+    v128_t query_min_y = wasm_i32x4_splat(query[1]);
+    v128_t query_max_x = wasm_i32x4_splat(query[2]);
+    v128_t query_max_y = wasm_i32x4_splat(query[3]);
+
+    int i = first;
+    for (; i + 4 <= last; i += 4)
+    {
+        v128_t misses_x = wasm_v128_or(wasm_i32x4_gt(wasm_v128_load(boxes->min_x + i), query_max_x), wasm_i32x4_gt(query_min_x, wasm_v128_load(boxes->max_x + i)));
+        v128_t misses_y = wasm_v128_or(wasm_i32x4_gt(wasm_v128_load(boxes->min_y + i), query_max_y), wasm_i32x4_gt(query_min_y, wasm_v128_load(boxes->max_y + i)));
+
+        Uint32 mask = ~wasm_i32x4_bitmask(wasm_v128_or(misses_x, misses_y)) & 0xF;
+        if (mask) { return i + BOX_GetFirstBit(mask); }
+    }
+
+    return BOX_FindIntersectionScalar(boxes, query, i, last);
+}
+#endif
+
+static BOX_Kernel BOX_SelectKernel(void)
+{
+#ifdef __wasm_simd128__
+    return BOX_FindIntersectionSIMD128;
+#else
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) { return BOX_FindIntersectionAVX2; }
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) { return BOX_FindIntersectionSSE2; }
+#endif
+    return BOX_FindIntersectionScalar;
+#endif
+}
+
+void BOX_ReserveBoxes(BOX_Boxes* boxes, int capacity)
+{
+    if (!BOX_kernel) { BOX_kernel = BOX_SelectKernel(); }
+    if (capacity <= boxes->capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(boxes->capacity * 2, BOX_MIN_CAPACITY));
+    boxes->min_x = SDL_realloc(boxes->min_x, capacity * sizeof(Sint32));
+    boxes->min_y = SDL_realloc(boxes->min_y, capacity * sizeof(Sint32));
+    boxes->max_x = SDL_realloc(boxes->max_x, capacity * sizeof(Sint32));
+    boxes->max_y = SDL_realloc(boxes->max_y, capacity * sizeof(Sint32));
+    boxes->capacity = capacity;
+}
+
+void BOX_QuitBoxes(BOX_Boxes* boxes)
+{
+    SDL_free(boxes->min_x);
+    SDL_free(boxes->min_y);
+    SDL_free(boxes->max_x);
+    SDL_free(boxes->max_y);
+}
+
+bool BOX_Intersects(const BOX_Boxes* boxes, int index, const SDL_Rect* rect)
+{
+    if ((rect->w < 0) || (rect->h < 0)) { return false; }
+
+    Sint32 query[4] = {rect->x, rect->y, rect->x + rect->w, rect->y + rect->h};
+    return BOX_Hit(boxes, index, query);
+}
+
+int BOX_FindIntersection(const BOX_Boxes* boxes, const SDL_Rect* rect, int first, int last)
+{
+    if ((rect->w < 0) || (rect->h < 0)) { return -1; }
+    if (!BOX_kernel) { BOX_kernel = BOX_SelectKernel(); }
+
+    Sint32 query[4] = {rect->x, rect->y, rect->x + rect->w, rect->y + rect->h};
+    return BOX_kernel(boxes, query, first, SDL_min(last, boxes->count));
+}
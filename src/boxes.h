@@ -0,0 +1,25 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_rect.h>
+
+typedef struct BOX_Boxes
+{
+    Sint32* min_x;
+    Sint32* min_y;
+    Sint32* max_x;
+    Sint32* max_y;
+    int count;
+    int capacity;
+}BOX_Boxes;
+
+void BOX_ReserveBoxes(BOX_Boxes* boxes, int capacity);
+
+void BOX_QuitBoxes(BOX_Boxes* boxes);
+
+void BOX_SetBox(BOX_Boxes* boxes, int index, const SDL_Rect* rect);
+
+void BOX_SetEmptyBox(BOX_Boxes* boxes, int index);
+
+bool BOX_Intersects(const BOX_Boxes* boxes, int index, const SDL_Rect* rect);
+
+int BOX_FindIntersection(const BOX_Boxes* boxes, const SDL_Rect* rect, int first, int last);
@@ -0,0 +1,135 @@
+#include "jobs.h"
+#include <SDL3/SDL_thread.h>
+
+typedef struct JOB_Worker
+{
+    JOB_Pool* pool;
+    SDL_Thread* thread;
+    SDL_Semaphore* start;
+    int index;
+}JOB_Worker;
+
+struct JOB_Pool
+{
+    JOB_Worker* workers;
+    int num_workers;
+    SDL_Semaphore* done;
+
+    JOB_Function function;
+    void* data;
+    int count;
+    bool quit;
+};
+
+void JOB_RunChunk(JOB_Pool* pool, int chunk)
+{
+    int num_chunks = pool->num_workers + 1;
+    int first = (int)((Sint64)pool->count * chunk / num_chunks);
+    int last = (int)((Sint64)pool->count * (chunk + 1) / num_chunks);
+
+    if (first < last) { pool->function(pool->data, first, last); }
+}
+
+int JOB_WorkerMain(void* user_data)
+{
+    JOB_Worker* worker = user_data;
+    JOB_Pool* pool = worker->pool;
+
+    while (true)
+    {
+        SDL_WaitSemaphore(worker->start);
+        if (pool->quit) { break; }
+
+        JOB_RunChunk(pool, worker->index + 1);
+        SDL_SignalSemaphore(pool->done);
+    }
+
+    return 0;
+}
+
+JOB_Pool* JOB_CreatePool(int num_workers)
+{
+    if (num_workers <= 0) { return NULL; }
+
+    JOB_Pool* pool = SDL_calloc(1, sizeof(JOB_Pool));
+    pool->workers = SDL_calloc(num_workers, sizeof(JOB_Worker));
+    pool->done = SDL_CreateSemaphore(0);
+    if (!pool->done)
+    {
+        JOB_DestroyPool(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < num_workers; i++)
+    {
+        JOB_Worker* worker = &pool->workers[pool->num_workers];
+        worker->pool = pool;
+        worker->index = pool->num_workers;
+        worker->start = SDL_CreateSemaphore(0);
+        if (!worker->start) { break; }
+
+        worker->thread = SDL_CreateThread(JOB_WorkerMain, "TRON worker", worker);
+        if (!worker->thread)
+        {
+            SDL_DestroySemaphore(worker->start);
+            break;
+        }
+        pool->num_workers++;
+    }
+
+    if (pool->num_workers == 0)
+    {
+        JOB_DestroyPool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void JOB_DestroyPool(JOB_Pool* pool)
+{
+    if (!pool) { return; }
+
+    pool->quit = true;
+    for (int i = 0; i < pool->num_workers; i++)
+    {
+        SDL_SignalSemaphore(pool->workers[i].start);
+    }
+    for (int i = 0; i < pool->num_workers; i++)
+    {
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+        SDL_DestroySemaphore(pool->workers[i].start);
+    }
+
+    SDL_DestroySemaphore(pool->done);
+    SDL_free(pool->workers);
+    SDL_free(pool);
+}
+
+int JOB_GetNumWorkers(JOB_Pool* pool)
+{
+    return pool ? pool->num_workers : 0;
+}
+
+void JOB_Run(JOB_Pool* pool, JOB_Function function, void* data, int count)
+{
+    if (!pool)
+    {
+        function(data, 0, count);
+        return;
+    }
+
+    pool->function = function;
+    pool->data = data;
+    pool->count = count;
+
+    for (int i = 0; i < pool->num_workers; i++)
+    {
+        SDL_SignalSemaphore(pool->workers[i].start);
+    }
+    JOB_RunChunk(pool, 0);
+    for (int i = 0; i < pool->num_workers; i++)
+    {
+        SDL_WaitSemaphore(pool->done);
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+typedef void (*JOB_Function)(void* data, int first, int last);
+
+typedef struct JOB_Pool JOB_Pool;
+
+JOB_Pool* JOB_CreatePool(int num_workers);
+
+void JOB_DestroyPool(JOB_Pool* pool);
+
+int JOB_GetNumWorkers(JOB_Pool* pool);
+
+void JOB_Run(JOB_Pool* pool, JOB_Function function, void* data, int count);
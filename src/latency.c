@@ -0,0 +1,150 @@
+#include "latency.h"
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_thread.h>
+
+#define LAT_MAX_INPUTS 64
+#define LAT_MIN_SAMPLE_CAPACITY 256
+
+typedef struct LAT_Input
+{
+    Uint64 timestamp;
+    Uint64 tick;
+    int bike;
+    bool simulated;
+}LAT_Input;
+
+typedef struct LAT_Samples
+{
+    Uint64* values;
+    int count;
+    int capacity;
+}LAT_Samples;
+
+struct LAT_Probe
+{
+    SDL_Mutex* lock;
+    LAT_Input inputs[LAT_MAX_INPUTS];
+    int num_inputs;
+    int dropped;
+    LAT_Samples simulated;
+    LAT_Samples presented;
+};
+
+LAT_Probe* LAT_CreateProbe(void)
+{
+    LAT_Probe* probe = SDL_calloc(1, sizeof(LAT_Probe));
+    probe->lock = SDL_CreateMutex();
+    return probe;
+}
+
+void LAT_DestroyProbe(LAT_Probe* probe)
+{
+    if (!probe) { return; }
+
+    SDL_DestroyMutex(probe->lock);
+    SDL_free(probe->simulated.values);
+    SDL_free(probe->presented.values);
+    SDL_free(probe);
+}
+
+void LAT_AddSample(LAT_Samples* samples, Uint64 value)
+{
+    if (samples->count == samples->capacity)
+    {
+        samples->capacity = SDL_max(samples->capacity * 2, LAT_MIN_SAMPLE_CAPACITY);
+        samples->values = SDL_realloc(samples->values, samples->capacity * sizeof(Uint64));
+    }
+    samples->values[samples->count++] = value;
+}
+
+void LAT_AddInput(LAT_Probe* probe, Uint64 timestamp, Uint64 tick, int bike)
+{
+    SDL_LockMutex(probe->lock);
+    if (probe->num_inputs == LAT_MAX_INPUTS)
+    {
+        probe->dropped++;
+    }
+    else
+    {
+        probe->inputs[probe->num_inputs++] = (LAT_Input){timestamp, tick, bike, false};
+    }
+    SDL_UnlockMutex(probe->lock);
+}
+
+void LAT_ResolveInputs(LAT_Probe* probe, TRON_World* world, Uint64 now)
+{
+    Uint64 tick = TRON_GetWorldTick(world);
+
+    SDL_LockMutex(probe->lock);
+    int count = 0;
+    for (int i = 0; i < probe->num_inputs; i++)
+    {
+        LAT_Input* input = &probe->inputs[i];
+        if ((!input->simulated) && (input->tick <= tick))
+        {
+            if (TRON_GetBikeTurnTick(world, input->bike) != (Sint64)input->tick) { continue; }
+
+            LAT_AddSample(&probe->simulated, now - SDL_min(input->timestamp, now));
+            input->simulated = true;
+        }
+        probe->inputs[count++] = *input;
+    }
+    probe->num_inputs = count;
+    SDL_UnlockMutex(probe->lock);
+}
+
+void LAT_PresentInputs(LAT_Probe* probe, Uint64 tick, Uint64 now)
+{
+    SDL_LockMutex(probe->lock);
+    int count = 0;
+    for (int i = 0; i < probe->num_inputs; i++)
+    {
+        LAT_Input* input = &probe->inputs[i];
+        if ((input->simulated) && (input->tick <= tick))
+        {
+            LAT_AddSample(&probe->presented, now - SDL_min(input->timestamp, now));
+            continue;
+        }
+        probe->inputs[count++] = *input;
+    }
+    probe->num_inputs = count;
+    SDL_UnlockMutex(probe->lock);
+}
+
+void LAT_ClearInputs(LAT_Probe* probe)
+{
+    SDL_LockMutex(probe->lock);
+    probe->num_inputs = 0;
+    SDL_UnlockMutex(probe->lock);
+}
+
+int LAT_CompareSamples(const void* a, const void* b)
+{
+    Uint64 first = *(const Uint64*)a;
+    Uint64 second = *(const Uint64*)b;
+    return first < second ? -1 : (first > second);
+}
+
+float LAT_GetPercentile(const LAT_Samples* samples, int percentile)
+{
+    return samples->values[(samples->count - 1) * percentile / 100] / (float)SDL_NS_PER_MS;
+}
+
+void LAT_LogSamples(LAT_Samples* samples, const char* name)
+{
+    if (samples->count == 0)
+    {
+        SDL_Log("%s latency: no samples", name);
+        return;
+    }
+
+    SDL_qsort(samples->values, samples->count, sizeof(Uint64), LAT_CompareSamples);
+    SDL_Log("%s latency: %d samples, min %.2f ms, p50 %.2f ms, p99 %.2f ms, max %.2f ms", name, samples->count, LAT_GetPercentile(samples, 0), LAT_GetPercentile(samples, 50), LAT_GetPercentile(samples, 99), LAT_GetPercentile(samples, 100));
+}
+
+void LAT_LogReport(LAT_Probe* probe)
+{
+    LAT_LogSamples(&probe->simulated, "input to simulation");
+    LAT_LogSamples(&probe->presented, "input to present");
+    if (probe->dropped > 0) { SDL_Log("latency probe dropped %d inputs", probe->dropped); }
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include "tron.h"
+
+typedef struct LAT_Probe LAT_Probe;
+
+LAT_Probe* LAT_CreateProbe(void);
+
+void LAT_DestroyProbe(LAT_Probe* probe);
+
+void LAT_AddInput(LAT_Probe* probe, Uint64 timestamp, Uint64 tick, int bike);
+
+void LAT_ResolveInputs(LAT_Probe* probe, TRON_World* world, Uint64 now);
+
+void LAT_PresentInputs(LAT_Probe* probe, Uint64 tick, Uint64 now);
+
+void LAT_ClearInputs(LAT_Probe* probe);
+
+void LAT_LogReport(LAT_Probe* probe);
@@ -2,45 +2,121 @@
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 #include "animation.h"
+#include "latency.h"
+#include "minimap.h"
+#include "netplay.h"
+#include "render.h"
+#include "replay.h"
+#include "simulation.h"
+#include "text.h"
+#include "trails.h"
+#include "tron.h"
 
 #define TRON_LOGICAL_WIDTH 1920
 #define TRON_LOGICAL_HEIGHT 1080
 #define TRON_TITLE_SCALE 10.0f
 #define TRON_PLAYER_CHOICE_SCALE 5.0f
 #define TRON_MAX_BIKES 4
-#define TRON_BIKE_WIDTH 50
-#define TRON_BIKE_HEIGHT 70
-#define TRON_BIKE_SPEED 4.0f
-#define TRON_TRAIL_SIZE 10.0f
-#define TRON_TURN_COOLDOWN 50
-
-typedef enum TRON_Direction
-{
-    TRON_NORTH,
-    TRON_EAST,
-    TRON_SOUTH,
-    TRON_WEST
-}TRON_Direction;
-
-typedef struct TRON_Bike
-{
-    SDL_FPoint position;
-    TRON_Direction direction;
-    float speed;
-    SDL_Color color;
-    SDL_FPoint* trail_points;
-    int num_trail_points;
-    SDL_Color trail_color;
-    Sint64 last_turn;
-    bool dead;
-}TRON_Bike;
+#define TRON_TICK_NS (SDL_NS_PER_SECOND / TRON_TICK_RATE)
+#define TRON_STATS_SCALE 2.0f
+#define TRON_MIN_ARENA_SIZE 400.0f
+#define TRON_MAX_ARENA_SIZE 65536.0f
+#define TRON_CAMERA_MARGIN 400.0f
+#define TRON_MIN_CAMERA_ZOOM 0.05f
+#define TRON_MAX_VIEWS TRON_MAX_BIKES
+#define TRON_VIEW_DIVIDER_SIZE 4.0f
+#define TRON_MIN_ERASED_CAPACITY 64
+#define TRON_MINIMAP_RESOLUTION 256
+#define TRON_MINIMAP_SIZE 320.0f
+#define TRON_MINIMAP_MARGIN 20.0f
+#define TRON_REPLAY_SEEK_TICKS (TRON_TICK_RATE * 10)
+#define TRON_REPLAY_SCALE 2.0f
+#define TRON_NET_PORT 47000
+#define TRON_LOOPBACK_MAX_MS 300000
+#define TRON_LOOPBACK_TURN_ODDS 400
+
+typedef enum TRON_Layer
+{
+    TRON_LAYER_BACKGROUND,
+    TRON_LAYER_ANIMATIONS,
+    TRON_LAYER_TRAILS,
+    TRON_LAYER_BIKES,
+    TRON_LAYER_DIVIDERS,
+    TRON_LAYER_MINIMAP,
+    TRON_LAYER_MENU,
+    TRON_LAYER_STATS
+}TRON_Layer;
+
+typedef struct TRON_TrailLayer
+{
+    SDL_Texture* texture;
+    int* heads;
+    SDL_FPoint* points;
+    bool* dead;
+    int bike_capacity;
+    int num_segments;
+    SDL_FRect* erased;
+    int num_erased;
+    int erased_capacity;
+    bool dirty;
+}TRON_TrailLayer;
+
+typedef struct TRON_Camera
+{
+    SDL_FPoint center;
+    float zoom;
+}TRON_Camera;
+
+typedef struct TRON_View
+{
+    TRON_Camera camera;
+    SDL_FRect rect;
+}TRON_View;
+
+typedef struct TRON_KeyBinding
+{
+    Sint8 bike;
+    Uint8 direction;
+}TRON_KeyBinding;
 
 typedef struct TRON_AppState
 {
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Scancode keys[TRON_MAX_BIKES][4];
-    TRON_Bike* bikes;
+    TRON_KeyBinding bindings[SDL_SCANCODE_COUNT];
+    LAT_Probe* latency_probe;
+    const char* record_prefix;
+    RPL_Recorder* recorder;
+    int num_rounds;
+    const char* play_path;
+    const char* replay_path;
+    const char* compare_paths[2];
+    RPL_Player* replay;
+    bool replay_paused;
+    NPL_Session* session;
+    int net_player;
+    Uint16 net_port;
+    const char* net_peers[TRON_MAX_BIKES];
+    NPL_Conditions net_conditions;
+    int net_delay;
+    int loopback_players;
+    TRON_World* world;
+    SIM_Simulation* simulation;
+    TRON_World* state;
+    Uint64 state_time;
+    Uint64 rendered_tick;
+    RND_Queue* queue;
+    RND_Queue* world_queue;
+    RND_Stats render_stats;
+    bool show_stats;
+    TRON_TrailLayer trail_layer;
+    TRL_Index* trail_index;
+    MAP_Minimap* minimap;
+    SDL_FPoint arena;
+    TRON_View views[TRON_MAX_VIEWS];
+    int num_views;
+    bool split_screen;
     int num_bikes;
     bool game_started;
     bool game_ended;
@@ -73,199 +149,445 @@ static const SDL_Scancode TRON_DEFAULT_KEYS[TRON_MAX_BIKES][4] =
     { SDL_SCANCODE_T, SDL_SCANCODE_H, SDL_SCANCODE_G, SDL_SCANCODE_F }
 };
 
-static SDL_Texture* TRON_title_text = NULL;
-static SDL_Texture* TRON_draw_text = NULL;
-static SDL_Texture* TRON_start_text = NULL;
-static SDL_Texture* TRON_player_texts[TRON_MAX_BIKES] = {0};
-static SDL_Texture* TRON_death_texts[TRON_MAX_BIKES] = {0};
-static SDL_Texture* TRON_win_texts[TRON_MAX_BIKES] = {0};
+static const SDL_Color TRON_BIKE_COLORS[TRON_MAX_BIKES] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}, {255, 255, 0, 255}};
+
+static const char* TRON_PLAYER_CHOICE_TEXTS[TRON_MAX_BIKES] = {"2 player", "3 player", "4 player", "Quit"};
+
+static TXT_Atlas* TRON_text_atlas = NULL;
 
 static ANI_Animation* TRON_death_text_animation = NULL;
 static ANI_Animation* TRON_start_animation = NULL;
 
-SDL_Texture* TRON_CreateText(SDL_Renderer* renderer, const char* text)
+SDL_FPoint TRON_GetLogicalCenter()
+{
+    return (SDL_FPoint){TRON_LOGICAL_WIDTH / 2.0f, TRON_LOGICAL_HEIGHT / 2.0f};
+}
+
+SDL_FPoint TRON_GetInterpolatedPosition(TRON_World* world, int bike, float alpha)
 {
-    size_t length = SDL_strlen(text);
-    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE * length, SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE);
-    SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
-    SDL_SetRenderTarget(renderer, texture);
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    SDL_RenderDebugText(renderer, 0.0f, 0.0f, text);
-    SDL_SetRenderTarget(renderer, NULL);
+    SDL_FPoint previous = TRON_GetBikePreviousPosition(world, bike);
+    SDL_FPoint current = TRON_GetBikePosition(world, bike);
+    return (SDL_FPoint){previous.x + (current.x - previous.x) * alpha, previous.y + (current.y - previous.y) * alpha};
+}
 
-    return texture;
+bool TRON_ArenaFitsView(TRON_AppState* app)
+{
+    return (app->arena.x <= TRON_LOGICAL_WIDTH) && (app->arena.y <= TRON_LOGICAL_HEIGHT);
 }
 
-void TRON_CenterRect(SDL_FRect* rect)
+SDL_FRect TRON_GetCameraView(const TRON_View* view)
 {
-    rect->x -= rect->w / 2.0f;
-    rect->y -= rect->h / 2.0f;
+    float width = view->rect.w / view->camera.zoom;
+    float height = view->rect.h / view->camera.zoom;
+    return (SDL_FRect){view->camera.center.x - width / 2.0f, view->camera.center.y - height / 2.0f, width, height};
 }
 
-SDL_FPoint TRON_GetLogicalCenter()
+RND_View TRON_GetRenderView(const TRON_View* view)
 {
-    return (SDL_FPoint){TRON_LOGICAL_WIDTH / 2.0f, TRON_LOGICAL_HEIGHT / 2.0f};
+    float scale = view->camera.zoom;
+    SDL_FPoint offset = {view->rect.x + view->rect.w / 2.0f - view->camera.center.x * scale, view->rect.y + view->rect.h / 2.0f - view->camera.center.y * scale};
+    SDL_Rect clip = {(int)view->rect.x, (int)view->rect.y, (int)view->rect.w, (int)view->rect.h};
+    return (RND_View){offset, scale, clip};
+}
+
+float TRON_ClampCameraAxis(float center, float view, float arena)
+{
+    if (arena <= view) { return arena / 2.0f; }
+    return SDL_clamp(center, view / 2.0f, arena - view / 2.0f);
+}
+
+void TRON_ResetViews(TRON_AppState* app)
+{
+    app->num_views = 1;
+    app->views[0] = (TRON_View){{{app->arena.x / 2.0f, app->arena.y / 2.0f}, 1.0f}, {0.0f, 0.0f, TRON_LOGICAL_WIDTH, TRON_LOGICAL_HEIGHT}};
 }
 
-SDL_FRect TRON_GetBikeRect(TRON_Bike* bike)
+void TRON_FitCamera(TRON_AppState* app, TRON_View* view, float alpha)
 {
-    if ((bike->direction == TRON_NORTH) || (bike->direction == TRON_SOUTH))
+    SDL_FPoint min = {app->arena.x, app->arena.y};
+    SDL_FPoint max = {0.0f, 0.0f};
+    for (int i = 0; i < TRON_GetNumBikes(app->state); i++)
     {
-        return (SDL_FRect){bike->position.x - TRON_BIKE_WIDTH / 2, bike->position.y - TRON_BIKE_HEIGHT / 2, TRON_BIKE_WIDTH, TRON_BIKE_HEIGHT};
+        if (TRON_IsBikeDead(app->state, i)) { continue; }
+
+        SDL_FPoint position = TRON_GetInterpolatedPosition(app->state, i, alpha);
+        min = (SDL_FPoint){SDL_min(min.x, position.x), SDL_min(min.y, position.y)};
+        max = (SDL_FPoint){SDL_max(max.x, position.x), SDL_max(max.y, position.y)};
     }
-    else
+    if ((min.x > max.x) || (min.y > max.y)) { return; }
+
+    float width = max.x - min.x + TRON_CAMERA_MARGIN * 2.0f;
+    float height = max.y - min.y + TRON_CAMERA_MARGIN * 2.0f;
+    float zoom = SDL_min(1.0f, SDL_min(view->rect.w / width, view->rect.h / height));
+    zoom = SDL_max(zoom, SDL_min(view->rect.w / app->arena.x, view->rect.h / app->arena.y));
+    view->camera.zoom = SDL_max(zoom, TRON_MIN_CAMERA_ZOOM);
+
+    view->camera.center.x = TRON_ClampCameraAxis((min.x + max.x) / 2.0f, view->rect.w / view->camera.zoom, app->arena.x);
+    view->camera.center.y = TRON_ClampCameraAxis((min.y + max.y) / 2.0f, view->rect.h / view->camera.zoom, app->arena.y);
+}
+
+void TRON_FollowBike(TRON_AppState* app, TRON_View* view, int bike, float alpha)
+{
+    SDL_FPoint position = TRON_GetInterpolatedPosition(app->state, bike, alpha);
+    view->camera.zoom = 1.0f;
+    view->camera.center.x = TRON_ClampCameraAxis(position.x, view->rect.w, app->arena.x);
+    view->camera.center.y = TRON_ClampCameraAxis(position.y, view->rect.h, app->arena.y);
+}
+
+void TRON_UpdateViews(TRON_AppState* app, float alpha)
+{
+    TRON_ResetViews(app);
+    if (TRON_ArenaFitsView(app)) { return; }
+
+    if ((!app->split_screen) || (app->num_bikes < 2))
     {
-        return (SDL_FRect){bike->position.x - TRON_BIKE_HEIGHT / 2, bike->position.y - TRON_BIKE_WIDTH / 2, TRON_BIKE_HEIGHT, TRON_BIKE_WIDTH};
+        TRON_FitCamera(app, &app->views[0], alpha);
+        return;
+    }
+
+    int columns = 2;
+    int rows = app->num_bikes > 2 ? 2 : 1;
+    app->num_views = SDL_min(app->num_bikes, TRON_MAX_VIEWS);
+    for (int i = 0; i < app->num_views; i++)
+    {
+        TRON_View* view = &app->views[i];
+        view->rect = (SDL_FRect){(i % columns) * TRON_LOGICAL_WIDTH / (float)columns, (i / columns) * TRON_LOGICAL_HEIGHT / (float)rows, TRON_LOGICAL_WIDTH / (float)columns, TRON_LOGICAL_HEIGHT / (float)rows};
+        TRON_FollowBike(app, view, i, alpha);
     }
 }
 
-TRON_Bike* TRON_CreateBikes(SDL_Renderer* renderer)
+void TRON_AddViewDividers(TRON_AppState* app)
 {
-    SDL_FPoint positions[TRON_MAX_BIKES] = {{100.0f, 100.0f}, {TRON_LOGICAL_WIDTH - 100.0f, 100.0f}, {100.0f, TRON_LOGICAL_HEIGHT - 100.0f}, {TRON_LOGICAL_WIDTH - 100.0f, TRON_LOGICAL_HEIGHT - 100.0f}};
-    TRON_Direction directions[TRON_MAX_BIKES] = {TRON_SOUTH, TRON_SOUTH, TRON_NORTH, TRON_NORTH};
-    SDL_Color colors[TRON_MAX_BIKES] = {{255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}, {255, 255, 0, 255}};
-    TRON_Bike* bikes = SDL_calloc(TRON_MAX_BIKES, sizeof(TRON_Bike));
-
-    for (int i = 0; i < TRON_MAX_BIKES; i++)
+    for (int i = 1; i < app->num_views; i++)
     {
-        bikes[i].position = positions[i];
-        bikes[i].direction = directions[i];
-        bikes[i].speed = TRON_BIKE_SPEED;
-        bikes[i].num_trail_points = 1;
-        bikes[i].trail_points = SDL_malloc(2 * sizeof(SDL_FPoint));
-        bikes[i].trail_points[0] = positions[i];
-        bikes[i].num_trail_points = 2;
-        bikes[i].trail_points[1] = positions[i];
-        bikes[i].trail_color = colors[i];
-        bikes[i].color = colors[i];
+        SDL_FRect rect = app->views[i].rect;
+        SDL_FRect vertical = {rect.x - TRON_VIEW_DIVIDER_SIZE / 2.0f, rect.y, TRON_VIEW_DIVIDER_SIZE, rect.h};
+        SDL_FRect horizontal = {rect.x, rect.y - TRON_VIEW_DIVIDER_SIZE / 2.0f, rect.w, TRON_VIEW_DIVIDER_SIZE};
+        if (rect.x > 0.0f) { RND_AddRect(app->queue, TRON_LAYER_DIVIDERS, &vertical, (SDL_Color){0, 0, 0, 255}); }
+        if (rect.y > 0.0f) { RND_AddRect(app->queue, TRON_LAYER_DIVIDERS, &horizontal, (SDL_Color){0, 0, 0, 255}); }
     }
+}
 
-    return bikes;
+void TRON_CreateTrailLayer(SDL_Renderer* renderer, TRON_TrailLayer* layer, SDL_FPoint arena)
+{
+    layer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, (int)SDL_ceilf(arena.x), (int)SDL_ceilf(arena.y));
+    SDL_SetTextureBlendMode(layer->texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(layer->texture, SDL_SCALEMODE_NEAREST);
+    layer->dirty = true;
 }
 
-void TRON_DestroyBikes(TRON_Bike* bikes)
+void TRON_DestroyTrailLayer(TRON_TrailLayer* layer)
 {
-    for (int i = 0; i < TRON_MAX_BIKES; i++)
+    SDL_DestroyTexture(layer->texture);
+    SDL_free(layer->heads);
+    SDL_free(layer->points);
+    SDL_free(layer->dead);
+    SDL_free(layer->erased);
+    layer->texture = NULL;
+    layer->heads = NULL;
+    layer->points = NULL;
+    layer->dead = NULL;
+    layer->erased = NULL;
+    layer->bike_capacity = 0;
+    layer->erased_capacity = 0;
+}
+
+void TRON_ReserveTrailHeads(TRON_TrailLayer* layer, int capacity)
+{
+    if (capacity <= layer->bike_capacity) { return; }
+
+    layer->heads = SDL_realloc(layer->heads, capacity * sizeof(int));
+    layer->points = SDL_realloc(layer->points, capacity * sizeof(SDL_FPoint));
+    layer->dead = SDL_realloc(layer->dead, capacity * sizeof(bool));
+    SDL_memset(layer->heads + layer->bike_capacity, 0xFF, (capacity - layer->bike_capacity) * sizeof(int));
+    SDL_memset(layer->dead + layer->bike_capacity, 0, (capacity - layer->bike_capacity) * sizeof(bool));
+    layer->bike_capacity = capacity;
+}
+
+void TRON_ClearTrailLayer(RND_Queue* queue, TRON_TrailLayer* layer)
+{
+    RND_SetTarget(queue, layer->texture);
+    SDL_SetRenderDrawColor(RND_GetRenderer(queue), 0, 0, 0, 0);
+    SDL_RenderClear(RND_GetRenderer(queue));
+    RND_SetTarget(queue, NULL);
+
+    for (int i = 0; i < layer->bike_capacity; i++)
     {
-        SDL_free(bikes[i].trail_points);
+        layer->heads[i] = -1;
+        layer->dead[i] = false;
     }
-    SDL_free(bikes);
+    layer->num_segments = 0;
+    layer->dirty = false;
+}
+
+void TRON_AddTrail(RND_Queue* queue, SDL_FPoint start, SDL_FPoint end, int owner)
+{
+    SDL_FRect rect = TRL_GetSegmentRect(start, end);
+    RND_AddRect(queue, TRON_LAYER_TRAILS, &rect, TRON_BIKE_COLORS[owner % TRON_MAX_BIKES]);
 }
 
-void TRON_MoveBike(TRON_Bike* bike, float speed)
+SDL_FRect TRON_GetDrawnTrailRect(TRON_TrailLayer* layer, TRON_Segments* segments, int segment)
 {
-    switch (bike->direction)
+    int owner = segments->owners[segment];
+    SDL_FPoint start = TRON_GetFloatPoint(segments->starts[segment]);
+    SDL_FRect rect = TRL_GetSegmentRect(start, TRON_GetFloatPoint(segments->ends[segment]));
+    if (segment != layer->heads[owner]) { return rect; }
+
+    SDL_FRect drawn = TRL_GetSegmentRect(start, layer->points[owner]);
+    SDL_GetRectUnionFloat(&rect, &drawn, &rect);
+    return rect;
+}
+
+void TRON_AddErasedRect(TRON_TrailLayer* layer, const SDL_FRect* rect)
+{
+    if (layer->num_erased == layer->erased_capacity)
     {
-        case TRON_NORTH:
-            bike->position.y -= speed;
-            break;
-        case TRON_SOUTH:
-            bike->position.y += speed;
-            break;
-        case TRON_WEST:
-            bike->position.x -= speed;
-            break;
-        case TRON_EAST:
-            bike->position.x += speed;
-            break;
+        layer->erased_capacity = SDL_max(layer->erased_capacity * 2, TRON_MIN_ERASED_CAPACITY);
+        layer->erased = SDL_realloc(layer->erased, layer->erased_capacity * sizeof(SDL_FRect));
     }
+    layer->erased[layer->num_erased++] = *rect;
+}
 
-    bike->trail_points[bike->num_trail_points - 1] = bike->position;
+bool TRON_HasRevivedTrails(TRON_TrailLayer* layer, TRON_World* world)
+{
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        if ((layer->dead[i]) && (!TRON_IsBikeDead(world, i))) { return true; }
+    }
+    return false;
 }
 
-void TRON_MoveBikes(TRON_Bike* bikes, int num_bikes)
+void TRON_EraseDeadTrails(TRON_TrailLayer* layer, RND_Queue* queue, TRON_World* world)
 {
-    for (int i = 0; i < num_bikes; i++)
+    TRON_Segments segments = TRON_GetSegments(world);
+    SDL_Renderer* renderer = RND_GetRenderer(queue);
+    SDL_FRect bounds = {0};
+
+    layer->num_erased = 0;
+    for (int i = 0; i < layer->num_segments; i++)
+    {
+        int owner = segments.owners[i];
+        if ((layer->dead[owner]) || (!TRON_IsBikeDead(world, owner))) { continue; }
+
+        SDL_FRect rect = TRON_GetDrawnTrailRect(layer, &segments, i);
+        if (layer->num_erased == 0) { bounds = rect; }
+        SDL_GetRectUnionFloat(&bounds, &rect, &bounds);
+        TRON_AddErasedRect(layer, &rect);
+    }
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
     {
-        if (!bikes[i].dead)
+        if ((!layer->dead[i]) && (TRON_IsBikeDead(world, i))) { layer->heads[i] = -1; }
+        layer->dead[i] = TRON_IsBikeDead(world, i);
+    }
+    if (layer->num_erased == 0) { return; }
+
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_BLEND;
+    SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    RND_ReserveQuads(queue, layer->num_erased);
+    for (int i = 0; i < layer->num_erased; i++) { RND_AddRect(queue, TRON_LAYER_TRAILS, &layer->erased[i], (SDL_Color){0, 0, 0, 0}); }
+    RND_Flush(queue);
+    SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+
+    for (int i = 0; i < layer->num_segments; i++)
+    {
+        int owner = segments.owners[i];
+        if (layer->dead[owner]) { continue; }
+
+        SDL_FRect rect = TRON_GetDrawnTrailRect(layer, &segments, i);
+        if (!SDL_HasRectIntersectionFloat(&rect, &bounds)) { continue; }
+
+        for (int k = 0; k < layer->num_erased; k++)
         {
-            TRON_MoveBike(&bikes[i], bikes[i].speed);
+            SDL_FRect overlap;
+            if (SDL_GetRectIntersectionFloat(&rect, &layer->erased[k], &overlap))
+            {
+                RND_AddRect(queue, TRON_LAYER_TRAILS, &overlap, TRON_BIKE_COLORS[owner % TRON_MAX_BIKES]);
+            }
         }
     }
 }
 
-bool TRON_TurnBike(TRON_Bike* bike, TRON_Direction direction)
+void TRON_ExtendTrailHeads(TRON_TrailLayer* layer, RND_Queue* queue, TRON_World* world)
 {
-    if (!bike->dead)
+    TRON_Segments segments = TRON_GetSegments(world);
+
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
     {
-        if ((direction != bike->direction) && (direction != (bike->direction + 2) % 4))
+        int head = layer->heads[i];
+        if ((head < 0) || (TRON_IsBikeDead(world, i))) { continue; }
+
+        bool growing = (head == TRON_GetBikeHeadSegment(world, i));
+        SDL_FPoint end = growing ? TRON_GetBikePosition(world, i) : TRON_GetFloatPoint(segments.ends[head]);
+        TRON_AddTrail(queue, layer->points[i], end, i);
+        layer->points[i] = end;
+        layer->heads[i] = growing ? head : -1;
+    }
+}
+
+void TRON_AddNewTrails(TRON_TrailLayer* layer, RND_Queue* queue, TRON_World* world)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+
+    RND_ReserveQuads(queue, segments.count - layer->num_segments);
+    for (int i = layer->num_segments; i < segments.count; i++)
+    {
+        int owner = segments.owners[i];
+        if (TRON_IsBikeDead(world, owner)) { continue; }
+
+        bool growing = (i == TRON_GetBikeHeadSegment(world, owner));
+        SDL_FPoint end = growing ? TRON_GetBikePosition(world, owner) : TRON_GetFloatPoint(segments.ends[i]);
+        TRON_AddTrail(queue, TRON_GetFloatPoint(segments.starts[i]), end, owner);
+        if (growing)
         {
-            bike->num_trail_points++;
-            bike->trail_points = SDL_realloc(bike->trail_points, bike->num_trail_points * sizeof(SDL_FPoint));
-            bike->trail_points[bike->num_trail_points - 1] = bike->position;
-            bike->direction = direction;
-            TRON_MoveBike(bike, direction % 2 == 0 ? TRON_BIKE_HEIGHT / 4.0f : TRON_BIKE_WIDTH / 4.0f);
-            return true;
+            layer->heads[owner] = i;
+            layer->points[owner] = end;
         }
     }
+    layer->num_segments = segments.count;
+}
 
-    return false;
+void TRON_UpdateTrailLayer(RND_Queue* queue, TRON_TrailLayer* layer, TRON_World* world)
+{
+    TRON_ReserveTrailHeads(layer, TRON_GetNumBikes(world));
+    if ((layer->dirty) || (TRON_GetSegments(world).count < layer->num_segments) || (TRON_HasRevivedTrails(layer, world)))
+    {
+        TRON_ClearTrailLayer(queue, layer);
+    }
+
+    RND_SetTarget(queue, layer->texture);
+    TRON_EraseDeadTrails(layer, queue, world);
+    TRON_ExtendTrailHeads(layer, queue, world);
+    TRON_AddNewTrails(layer, queue, world);
+    RND_SetTarget(queue, NULL);
 }
 
-void TRON_RenderBikeTrail(SDL_Renderer* renderer, TRON_Bike* bike)
+void TRON_AddVisibleTrails(RND_Queue* queue, TRL_Index* index, TRON_World* world, const TRON_View* views, int num_views, float alpha)
 {
-    SDL_SetRenderDrawColor(renderer, bike->trail_color.r, bike->trail_color.g, bike->trail_color.b, bike->trail_color.a);
-    SDL_SetRenderScale(renderer, TRON_TRAIL_SIZE, TRON_TRAIL_SIZE);
-    for (int i = 1; i < bike->num_trail_points; i++)
+    TRL_UpdateIndex(index, world);
+
+    SDL_FRect areas[TRON_MAX_VIEWS];
+    for (int i = 0; i < num_views; i++) { areas[i] = TRON_GetCameraView(&views[i]); }
+
+    const int* visible = NULL;
+    int count = TRL_QueryIndex(index, areas, num_views, &visible);
+
+    TRON_Segments segments = TRON_GetSegments(world);
+    RND_ReserveQuads(queue, count);
+    for (int i = 0; i < count; i++)
     {
-        SDL_RenderLine(renderer, (bike->trail_points[i - 1].x - TRON_TRAIL_SIZE / 2) / TRON_TRAIL_SIZE,
-                                 (bike->trail_points[i - 1].y - TRON_TRAIL_SIZE / 2) / TRON_TRAIL_SIZE,
-                                 (bike->trail_points[i - 0].x - TRON_TRAIL_SIZE / 2) / TRON_TRAIL_SIZE,
-                                 (bike->trail_points[i - 0].y - TRON_TRAIL_SIZE / 2) / TRON_TRAIL_SIZE);
+        int segment = visible[i];
+        int owner = segments.owners[segment];
+        if (TRON_IsBikeDead(world, owner)) { continue; }
+
+        SDL_FPoint end = (segment == TRON_GetBikeHeadSegment(world, owner)) ? TRON_GetInterpolatedPosition(world, owner, alpha) : TRON_GetFloatPoint(segments.ends[segment]);
+        SDL_FRect rect = TRL_GetSegmentRect(TRON_GetFloatPoint(segments.starts[segment]), end);
+        RND_AddRect(queue, TRON_LAYER_TRAILS, &rect, TRON_BIKE_COLORS[owner % TRON_MAX_BIKES]);
     }
-    SDL_SetRenderScale(renderer, 1.0f, 1.0f);
 }
 
-void TRON_RenderBike(SDL_Renderer* renderer, TRON_Bike* bike)
+bool TRON_IsRectVisible(const TRON_View* views, int num_views, const SDL_FRect* rect)
 {
-    SDL_SetRenderDrawColor(renderer, bike->color.r, bike->color.g, bike->color.b, bike->color.a);
-    SDL_FRect rect = TRON_GetBikeRect(bike);
-    SDL_RenderFillRect(renderer, &rect);
+    for (int i = 0; i < num_views; i++)
+    {
+        SDL_FRect area = TRON_GetCameraView(&views[i]);
+        if (SDL_HasRectIntersectionFloat(rect, &area)) { return true; }
+    }
+
+    return false;
 }
 
-void TRON_RenderBikes(SDL_Renderer* renderer, TRON_Bike* bikes, int num_bikes)
+void TRON_AddBikes(RND_Queue* queue, TRON_World* world, const TRON_View* views, int num_views, float alpha)
 {
-    for (int i = 0; i < num_bikes; i++)
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
     {
-        if (!bikes[i].dead)
+        if (TRON_IsBikeDead(world, i)) { continue; }
+
+        SDL_FRect rect = TRON_GetBikeRectAt(TRON_GetBikeDirection(world, i), TRON_GetInterpolatedPosition(world, i, alpha));
+        if (TRON_IsRectVisible(views, num_views, &rect))
         {
-            TRON_RenderBikeTrail(renderer, &bikes[i]);
+            RND_AddRect(queue, TRON_LAYER_BIKES, &rect, TRON_BIKE_COLORS[i % TRON_MAX_BIKES]);
         }
     }
-    for (int i = 0; i < num_bikes; i++)
+}
+
+void TRON_RenderBikes(TRON_AppState* app, float alpha)
+{
+    if (TRON_ArenaFitsView(app))
     {
-        if (!bikes[i].dead)
-        {
-            TRON_RenderBike(renderer, &bikes[i]);
-        }
+        TRON_UpdateTrailLayer(app->world_queue, &app->trail_layer, app->state);
+
+        SDL_FRect rect = {0.0f, 0.0f, app->arena.x, app->arena.y};
+        SDL_FRect uv = {0.0f, 0.0f, 1.0f, 1.0f};
+        RND_AddRotatedQuad(app->world_queue, TRON_LAYER_TRAILS, app->trail_layer.texture, &rect, &uv, (SDL_FPoint){0.0f, 0.0f}, 0.0f, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f});
     }
+    else
+    {
+        TRON_AddVisibleTrails(app->world_queue, app->trail_index, app->state, app->views, app->num_views, alpha);
+    }
+    TRON_AddBikes(app->world_queue, app->state, app->views, app->num_views, alpha);
+    TRON_AddViewDividers(app);
 }
 
-void TRON_GameplayKeyDown(TRON_AppState* app, SDL_Event* event)
+void TRON_RenderMinimap(TRON_AppState* app)
 {
-    for (int i = 0; i < app->num_bikes; i++)
+    if (!app->minimap) { return; }
+
+    MAP_UpdateMinimap(app->minimap, app->state);
+
+    SDL_FPoint size = MAP_GetMinimapSize(app->minimap);
+    float scale = TRON_MINIMAP_SIZE / SDL_max(size.x, size.y);
+    SDL_FRect rect = {TRON_LOGICAL_WIDTH - TRON_MINIMAP_MARGIN - size.x * scale, TRON_LOGICAL_HEIGHT - TRON_MINIMAP_MARGIN - size.y * scale, size.x * scale, size.y * scale};
+    RND_AddRect(app->queue, TRON_LAYER_MINIMAP, &rect, (SDL_Color){0, 0, 0, 160});
+    MAP_AddMinimap(app->minimap, app->queue, TRON_LAYER_MINIMAP, &rect);
+}
+
+void TRON_BuildKeyBindings(TRON_AppState* app)
+{
+    for (int i = 0; i < SDL_SCANCODE_COUNT; i++) { app->bindings[i] = (TRON_KeyBinding){-1, 0}; }
+    for (int i = 0; i < TRON_MAX_BIKES; i++)
     {
         for (int j = 0; j < 4; j++)
         {
-            if (event->key.scancode == app->keys[i][j])
-            {
-                if (SDL_GetTicks() - app->bikes[i].last_turn > TRON_TURN_COOLDOWN)
-                {
-                    if (TRON_TurnBike(&app->bikes[i], j))
-                    {
-                        app->bikes[i].last_turn = SDL_GetTicks();
-                    }
-                }
-            }
+            app->bindings[app->keys[i][j]] = (TRON_KeyBinding){i, j};
         }
     }
 }
 
+void TRON_GameplayKeyDown(TRON_AppState* app, SDL_Event* event)
+{
+    if (event->key.scancode >= SDL_SCANCODE_COUNT) { return; }
+
+    TRON_KeyBinding binding = app->bindings[event->key.scancode];
+    if ((binding.bike < 0) || (binding.bike >= app->num_bikes)) { return; }
+
+    SIM_PushTurn(app->simulation, binding.bike, binding.direction, event->key.timestamp);
+}
+
+void TRON_NetplayKeyDown(TRON_AppState* app, SDL_Event* event)
+{
+    if (event->key.scancode >= SDL_SCANCODE_COUNT) { return; }
+
+    TRON_KeyBinding binding = app->bindings[event->key.scancode];
+    if (binding.bike < 0) { return; }
+
+    NPL_PushTurn(app->session, binding.direction, event->key.timestamp);
+}
+
 void TRON_StartCallback(void* userdata)
 {
     TRON_AppState* app = userdata;
     app->game_started = true;
     app->hide_menu = false;
+    app->rendered_tick = 0;
+    if (app->latency_probe) { LAT_ClearInputs(app->latency_probe); }
+    if (app->record_prefix)
+    {
+        app->recorder = RPL_CreateRecorder(app->world);
+        SIM_SetRecorder(app->simulation, app->recorder);
+    }
+    SIM_StartSimulation(app->simulation, SDL_GetTicksNS());
+    app->state = SIM_AcquireState(app->simulation, &app->state_time);
 }
 
 bool TRON_MenuKeyDown(TRON_AppState* app, SDL_Event* event)
@@ -284,194 +606,277 @@ bool TRON_MenuKeyDown(TRON_AppState* app, SDL_Event* event)
     {
         if (app->player_choice == 3) { return false; }
         app->num_bikes = app->player_choice + 2;
+        TRON_ResetWorld(app->world, app->num_bikes);
         app->hide_menu = true;
-        ANI_PlayAnimationWithCallback(TRON_start_animation, TRON_start_text, TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_StartCallback, app);
+        ANI_PlayTextAnimationWithCallback(TRON_start_animation, TRON_text_atlas, "Starting Game !", TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_StartCallback, app);
     }
 
     return true;
 }
 
-bool TRON_RectIntersectsTrail(SDL_FRect* rect, SDL_FPoint p1, SDL_FPoint p2)
+void TRON_RenderTitle(RND_Queue* queue)
 {
-    SDL_FRect seg_rect;
-    if (p1.x == p2.x)
-    {
-        seg_rect.x = p1.x - TRON_TRAIL_SIZE / 2;
-        seg_rect.y = SDL_min(p1.y, p2.y);
-        seg_rect.w = TRON_TRAIL_SIZE;
-        seg_rect.h = SDL_fabsf(p2.y - p1.y);
-    }
-    else
-    {
-        seg_rect.x = SDL_min(p1.x, p2.x);
-        seg_rect.y = p1.y - TRON_TRAIL_SIZE / 2;
-        seg_rect.w = SDL_fabsf(p2.x - p1.x);
-        seg_rect.h = TRON_TRAIL_SIZE;
-    }
-    return SDL_HasRectIntersectionFloat(rect, &seg_rect);
+    SDL_FPoint center = TRON_GetLogicalCenter();
+    center.y -= TXT_GetTextSize("LIGHT BIKE").y * TRON_TITLE_SCALE * 2;
+    Uint8 r = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f) * 0.5f + 0.5f) * 255);
+    Uint8 g = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f + 2.0f) * 0.5f + 0.5f) * 255);
+    Uint8 b = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f + 4.0f) * 0.5f + 0.5f) * 255);
+    TXT_AddText(TRON_text_atlas, queue, TRON_LAYER_MENU, "LIGHT BIKE", center, (SDL_FPoint){TRON_TITLE_SCALE, TRON_TITLE_SCALE}, 0.0f, (SDL_Color){r, g, b, 255});
 }
 
-bool TRON_CheckBikeCollision(TRON_Bike* b1, TRON_Bike* b2)
+void TRON_RenderPlayerChoice(TRON_AppState* app)
 {
-    SDL_FRect r1 = TRON_GetBikeRect(b1);
-    SDL_FRect r2 = TRON_GetBikeRect(b2);
-
-    if ((r1.x < 0) || (r1.y < 0) || (r1.x + r1.w > TRON_LOGICAL_WIDTH) || (r1.y + r1.h > TRON_LOGICAL_HEIGHT))
+    for (int i = 0; i < TRON_MAX_BIKES; i++)
     {
-        return true;
+        SDL_FPoint center = TRON_GetLogicalCenter();
+        center.y += TXT_GetTextSize(TRON_PLAYER_CHOICE_TEXTS[i]).y * TRON_PLAYER_CHOICE_SCALE * 2 * (i + 1);
+
+        SDL_Color color = (app->player_choice == i) ? (SDL_Color){255, 50, 50, 255} : (SDL_Color){255, 255, 255, 255};
+        TXT_AddText(TRON_text_atlas, app->queue, TRON_LAYER_MENU, TRON_PLAYER_CHOICE_TEXTS[i], center, (SDL_FPoint){TRON_PLAYER_CHOICE_SCALE, TRON_PLAYER_CHOICE_SCALE}, 0.0f, color);
     }
-    if ((b1->direction != b2->direction) && (b1->direction % 2 == b2->direction % 2) && (SDL_HasRectIntersectionFloat(&r1, &r2)))
+}
+
+void TRON_RenderMenu(TRON_AppState* app)
+{
+    if (!app->hide_menu)
     {
-        return true;
+        TRON_RenderTitle(app->queue);
+        TRON_RenderPlayerChoice(app);
     }
-    for (int i = 1; i < b2->num_trail_points; i++)
+}
+
+void TRON_PlayDeathAnimations(TRON_AppState* app)
+{
+    for (int i = 0; i < app->num_bikes; i++)
     {
-        if (TRON_RectIntersectsTrail(&r1, b2->trail_points[i-1], b2->trail_points[i]))
+        if ((TRON_IsBikeDead(app->state, i)) && (TRON_GetBikeDeathTick(app->state, i) > app->rendered_tick))
         {
-            return true;
+            ANI_ClearAnimations();
+            char text[32];
+            SDL_snprintf(text, sizeof(text), "Player %d Died !", i + 1);
+            ANI_PlayTextAnimation(TRON_death_text_animation, TRON_text_atlas, text, TRON_GetLogicalCenter(), SDL_GetTicks());
         }
     }
-
-    return false;
 }
 
-void TRON_CheckBikesCollisions(TRON_Bike* bikes, int num_bikes)
+void TRON_UpdateGame(TRON_AppState* app)
 {
-    bool dead[TRON_MAX_BIKES] = {0};
-    for (int i = 0; i < num_bikes; i++)
+    SIM_UpdateSimulation(app->simulation);
+    app->state = SIM_AcquireState(app->simulation, &app->state_time);
+    if (TRON_GetWorldTick(app->state) > app->rendered_tick)
     {
-        for (int j = 0; j < num_bikes; j++)
-        {
-            if ((!bikes[i].dead) && (!bikes[j].dead))
-            {
-                if (i == j)
-                {
-                    bikes[i].num_trail_points -= 2;
-                }
-                if (TRON_CheckBikeCollision(&bikes[i], &bikes[j]))
-                {
-                    dead[i] = true;
-                    ANI_ClearAnimations();
-                    ANI_PlayAnimation(TRON_death_text_animation, TRON_death_texts[i], TRON_GetLogicalCenter(), SDL_GetTicks());
-                }
-                if (i == j)
-                {
-                    bikes[i].num_trail_points += 2;
-                }
-            }
-        }
-    }
-    for (int i = 0; i < num_bikes; i++)
-    {
-        if (dead[i])
-        {
-            bikes[i].dead = dead[i];
-        }
+        TRON_PlayDeathAnimations(app);
+        app->rendered_tick = TRON_GetWorldTick(app->state);
     }
 }
 
-void TRON_CreateTexts(SDL_Renderer* renderer)
+void TRON_RenderState(TRON_AppState* app, Uint64 now)
 {
-    TRON_player_texts[0] = TRON_CreateText(renderer, "2 player");
-    TRON_player_texts[1] = TRON_CreateText(renderer, "3 player");
-    TRON_player_texts[2] = TRON_CreateText(renderer, "4 player");
-    TRON_player_texts[3] = TRON_CreateText(renderer, "Quit");
-
-    TRON_death_texts[0] = TRON_CreateText(renderer, "Player 1 Died !");
-    TRON_death_texts[1] = TRON_CreateText(renderer, "Player 2 Died !");
-    TRON_death_texts[2] = TRON_CreateText(renderer, "Player 3 Died !");
-    TRON_death_texts[3] = TRON_CreateText(renderer, "Player 4 Died !");
+    float alpha = now > app->state_time ? SDL_min((now - app->state_time) / (float)TRON_TICK_NS, 1.0f) : 0.0f;
+    TRON_UpdateViews(app, alpha);
+    TRON_RenderBikes(app, alpha);
+    TRON_RenderMinimap(app);
+}
 
-    TRON_win_texts[0] = TRON_CreateText(renderer, "Player 1 Wins !");
-    TRON_win_texts[1] = TRON_CreateText(renderer, "Player 2 Wins !");
-    TRON_win_texts[2] = TRON_CreateText(renderer, "Player 3 Wins !");
-    TRON_win_texts[3] = TRON_CreateText(renderer, "Player 4 Wins !");
+void TRON_RenderGame(TRON_AppState* app)
+{
+    TRON_UpdateGame(app);
+    TRON_RenderState(app, SDL_GetTicksNS());
+}
 
-    TRON_title_text = TRON_CreateText(renderer, "LIGHT BIKE");
-    TRON_draw_text = TRON_CreateText(renderer, "Draw !");
-    TRON_start_text = TRON_CreateText(renderer, "Starting Game !");
+void TRON_InvalidateTrails(TRON_AppState* app)
+{
+    app->trail_layer.dirty = true;
+    if (app->trail_index) { TRL_ClearIndex(app->trail_index); }
+    if (app->minimap) { MAP_ClearMinimap(app->minimap); }
 }
 
-void TRON_DestroyTexts()
+void TRON_SeekReplay(TRON_AppState* app, Uint64 tick)
 {
-    for (int i = 0; i < TRON_MAX_BIKES; i++) { SDL_DestroyTexture(TRON_player_texts[i]); }
-    for (int i = 0; i < TRON_MAX_BIKES; i++) { SDL_DestroyTexture(TRON_death_texts[i]); }
-    for (int i = 0; i < TRON_MAX_BIKES; i++) { SDL_DestroyTexture(TRON_win_texts[i]); }
-    SDL_DestroyTexture(TRON_title_text);
-    SDL_DestroyTexture(TRON_draw_text);
-    SDL_DestroyTexture(TRON_start_text);
+    RPL_SeekReplay(app->replay, tick);
+    app->rendered_tick = TRON_GetWorldTick(app->state);
+    app->state_time = SDL_GetTicksNS();
+    TRON_InvalidateTrails(app);
 }
 
-int TRON_CountAliveBikes(TRON_Bike* bikes, int num_bikes)
+void TRON_ReplayKeyDown(TRON_AppState* app, SDL_Event* event)
 {
-    int count = 0;
-    for (int i = 0; i < num_bikes; i++)
+    Uint64 tick = TRON_GetWorldTick(app->state);
+    if (event->key.scancode == SDL_SCANCODE_SPACE)
+    {
+        app->replay_paused = !app->replay_paused;
+        app->state_time = SDL_GetTicksNS();
+    }
+    else if (event->key.scancode == SDL_SCANCODE_LEFT)
     {
-        if (!bikes[i].dead) { count++; }
+        TRON_SeekReplay(app, tick > TRON_REPLAY_SEEK_TICKS ? tick - TRON_REPLAY_SEEK_TICKS : 0);
+    }
+    else if (event->key.scancode == SDL_SCANCODE_RIGHT)
+    {
+        TRON_SeekReplay(app, tick + TRON_REPLAY_SEEK_TICKS);
+    }
+    else if (event->key.scancode == SDL_SCANCODE_HOME)
+    {
+        TRON_SeekReplay(app, 0);
+    }
+    else if (event->key.scancode == SDL_SCANCODE_END)
+    {
+        TRON_SeekReplay(app, RPL_GetReplayLength(app->replay));
     }
-    return count;
 }
 
-void TRON_RenderTitle(SDL_Renderer* renderer)
+void TRON_RenderReplay(TRON_AppState* app)
 {
-    SDL_FPoint center = TRON_GetLogicalCenter();
-    SDL_FRect rect = {center.x, center.y, TRON_title_text->w * TRON_TITLE_SCALE, TRON_title_text->h * TRON_TITLE_SCALE};
-    TRON_CenterRect(&rect);
-    rect.y -= rect.h * 2;
-    Uint8 r = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f) * 0.5f + 0.5f) * 255);
-    Uint8 g = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f + 2.0f) * 0.5f + 0.5f) * 255);
-    Uint8 b = (Uint8)((SDL_sinf(SDL_GetTicks() * 0.001f + 4.0f) * 0.5f + 0.5f) * 255);
-    SDL_SetTextureColorMod(TRON_title_text, r, g, b);
-    SDL_RenderTexture(renderer, TRON_title_text, NULL, &rect);
+    Uint64 now = SDL_GetTicksNS();
+    if (app->replay_paused) { app->state_time = now - TRON_TICK_NS; }
+    if (now > app->state_time + TRON_TICK_NS * TRON_TICK_RATE) { app->state_time = now - TRON_TICK_NS; }
+    while (app->state_time + TRON_TICK_NS <= now)
+    {
+        if (!RPL_StepReplay(app->replay))
+        {
+            app->state_time = now - TRON_TICK_NS;
+            break;
+        }
+        app->state_time += TRON_TICK_NS;
+    }
+    if (TRON_GetWorldTick(app->state) > app->rendered_tick)
+    {
+        TRON_PlayDeathAnimations(app);
+        app->rendered_tick = TRON_GetWorldTick(app->state);
+    }
+    TRON_RenderState(app, now);
+
+    char text[96];
+    Uint64 length = RPL_GetReplayLength(app->replay);
+    SDL_snprintf(text, sizeof(text), "%s %" SDL_PRIu64 " / %" SDL_PRIu64, app->replay_paused ? "paused" : "replay", app->rendered_tick, length);
+    SDL_FPoint size = TXT_GetTextSize(text);
+    SDL_FPoint center = {TRON_LOGICAL_WIDTH / 2.0f, TRON_LOGICAL_HEIGHT - size.y * TRON_REPLAY_SCALE};
+    TXT_AddText(TRON_text_atlas, app->queue, TRON_LAYER_STATS, text, center, (SDL_FPoint){TRON_REPLAY_SCALE, TRON_REPLAY_SCALE}, 0.0f, (SDL_Color){255, 255, 255, 255});
+
+    SDL_FRect bar = {0.0f, TRON_LOGICAL_HEIGHT - TRON_VIEW_DIVIDER_SIZE, TRON_LOGICAL_WIDTH * app->rendered_tick / (float)SDL_max(length, 1), TRON_VIEW_DIVIDER_SIZE};
+    RND_AddRect(app->queue, TRON_LAYER_STATS, &bar, (SDL_Color){255, 255, 255, 255});
 }
 
-void TRON_RenderPlayerChoice(TRON_AppState* app)
+SDL_AppResult TRON_PlayReplay(const char* path)
 {
-    SDL_FPoint center = TRON_GetLogicalCenter();
-    for (int i = 0; i < TRON_MAX_BIKES; i++)
+    RPL_Player* player = RPL_OpenReplay(path);
+    if (!player)
     {
-        SDL_FRect rect = {center.x, center.y, TRON_player_texts[i]->w * TRON_PLAYER_CHOICE_SCALE, TRON_player_texts[i]->h * TRON_PLAYER_CHOICE_SCALE};
-        TRON_CenterRect(&rect);
-        rect.y += rect.h * 2 * (i + 1);
-
-        if (app->player_choice == i)
-        {
-            SDL_SetTextureColorMod(TRON_player_texts[i], 255, 50, 50);
-        }
-        else
-        {
-            SDL_SetTextureColorMod(TRON_player_texts[i], 255, 255, 255);
-        }
+        SDL_Log("Failed to open replay %s: %s", path, SDL_GetError());
+        return SDL_APP_FAILURE;
+    }
 
-        SDL_RenderTexture(app->renderer, TRON_player_texts[i], NULL, &rect);
+    TRON_World* world = RPL_GetReplayWorld(player);
+    Sint64 desync = -1;
+    Uint64 start = SDL_GetTicksNS();
+    do
+    {
+        Uint64 tick = TRON_GetWorldTick(world);
+        Uint64 hash = 0;
+        if ((desync < 0) && (RPL_GetReplayHash(player, tick, &hash)) && (hash != TRON_GetWorldHash(world))) { desync = (Sint64)tick; }
     }
+    while (RPL_StepReplay(player));
+    Uint64 played = SDL_GetTicksNS() - start;
+
+    Uint64 length = RPL_GetReplayLength(player);
+    start = SDL_GetTicksNS();
+    RPL_SeekReplay(player, length / 2);
+    Uint64 seeked = SDL_GetTicksNS() - start;
+
+    RPL_SeekReplay(player, length);
+    SDL_Log("Replayed %" SDL_PRIu64 " ticks of %d bikes in %.2f ms (%.0f ticks/s), seek to middle %.2f ms, %d alive", length, RPL_GetReplayBikes(player), played / 1e6, length * 1e9 / SDL_max(played, 1), seeked / 1e6, TRON_CountAliveBikes(world));
+    if (desync >= 0) { SDL_Log("Replay desynced at tick %" SDL_PRIs64, desync); }
+    RPL_CloseReplay(player);
+
+    return desync < 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
 }
 
-void TRON_RenderMenu(TRON_AppState* app)
+SDL_AppResult TRON_CompareReplays(const char* paths[2])
 {
-    if (!app->hide_menu)
+    RPL_Player* players[2] = {RPL_OpenReplay(paths[0]), RPL_OpenReplay(paths[1])};
+    for (int i = 0; i < 2; i++)
     {
-        TRON_RenderTitle(app->renderer);
-        TRON_RenderPlayerChoice(app);
+        if (!players[i]) { SDL_Log("Failed to open replay %s: %s", paths[i], SDL_GetError()); }
     }
+    if ((!players[0]) || (!players[1]))
+    {
+        RPL_CloseReplay(players[0]);
+        RPL_CloseReplay(players[1]);
+        return SDL_APP_FAILURE;
+    }
+
+    Sint64 tick = RPL_FindDivergence(players[0], players[1]);
+    if (tick < 0)
+    {
+        SDL_Log("Replays match for all %" SDL_PRIu64 " ticks", RPL_GetReplayLength(players[0]));
+    }
+    else
+    {
+        SDL_Log("Replays diverge at tick %" SDL_PRIs64, tick);
+        RPL_SeekReplay(players[0], tick);
+        RPL_SeekReplay(players[1], tick);
+        TRON_World* first = RPL_GetReplayWorld(players[0]);
+        TRON_World* second = RPL_GetReplayWorld(players[1]);
+        int num_bikes = SDL_min(TRON_GetNumBikes(first), TRON_GetNumBikes(second));
+        for (int i = 0; i < num_bikes; i++)
+        {
+            SDL_FPoint a = TRON_GetBikePosition(first, i);
+            SDL_FPoint b = TRON_GetBikePosition(second, i);
+            bool dead_a = TRON_IsBikeDead(first, i);
+            bool dead_b = TRON_IsBikeDead(second, i);
+            if ((a.x == b.x) && (a.y == b.y) && (TRON_GetBikeDirection(first, i) == TRON_GetBikeDirection(second, i)) && (dead_a == dead_b)) { continue; }
+
+            SDL_Log("  bike %d: (%.2f, %.2f) dir %d%s vs (%.2f, %.2f) dir %d%s", i, a.x, a.y, TRON_GetBikeDirection(first, i), dead_a ? " dead" : "", b.x, b.y, TRON_GetBikeDirection(second, i), dead_b ? " dead" : "");
+        }
+    }
+
+    RPL_CloseReplay(players[0]);
+    RPL_CloseReplay(players[1]);
+    return tick < 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
 }
 
-void TRON_RenderGame(TRON_AppState* app)
+void TRON_FinishRecording(TRON_AppState* app)
 {
-    TRON_MoveBikes(app->bikes, app->num_bikes);
-    TRON_CheckBikesCollisions(app->bikes, app->num_bikes);
-
-    TRON_RenderBikes(app->renderer, app->bikes, app->num_bikes);
+    if (!app->recorder) { return; }
+
+    SIM_SetRecorder(app->simulation, NULL);
+    char path[1024];
+    SDL_snprintf(path, sizeof(path), "%s%03d.replay", app->record_prefix, ++app->num_rounds);
+    if (RPL_SaveRecording(app->recorder, path)) { SDL_Log("Recorded %s", path); }
+    else { SDL_Log("Failed to record %s: %s", path, SDL_GetError()); }
+    RPL_DestroyRecorder(app->recorder);
+    app->recorder = NULL;
 }
 
 void TRON_ResetGame(TRON_AppState* app)
 {
-    TRON_DestroyBikes(app->bikes);
+    if (app->session)
+    {
+        NPL_RestartSession(app->session);
+        app->game_ended = false;
+        app->rendered_tick = 0;
+        TRON_ResetViews(app);
+        TRON_InvalidateTrails(app);
+        return;
+    }
+
+    SIM_StopSimulation(app->simulation);
+    TRON_FinishRecording(app);
     app->num_bikes = TRON_MAX_BIKES;
-    app->bikes = TRON_CreateBikes(app->renderer);
+    TRON_ResetWorld(app->world, app->num_bikes);
     app->player_choice = 0;
     app->game_started = false;
     app->game_ended = false;
+    TRON_ResetViews(app);
+    if (TRON_ArenaFitsView(app))
+    {
+        TRON_ClearTrailLayer(app->world_queue, &app->trail_layer);
+    }
+    else
+    {
+        TRL_ClearIndex(app->trail_index);
+        if (app->minimap) { MAP_ClearMinimap(app->minimap); }
+    }
 }
 
 void TRON_DeathCallback(void* userdata)
@@ -485,42 +890,350 @@ void TRON_RenderDeathScreen(TRON_AppState* app)
     {
         for (int i = 0; i < app->num_bikes; i++)
         {
-            if (!app->bikes[i].dead)
+            if (!TRON_IsBikeDead(app->state, i))
             {
+                char text[32];
+                SDL_snprintf(text, sizeof(text), "Player %d Wins !", i + 1);
                 ANI_ClearAnimations();
-                ANI_PlayAnimationWithCallback(TRON_death_text_animation, TRON_win_texts[i], TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_DeathCallback, app);
+                ANI_PlayTextAnimationWithCallback(TRON_death_text_animation, TRON_text_atlas, text, TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_DeathCallback, app);
                 app->game_ended = true;
             }
         }
         if (!app->game_ended)
         {
             ANI_ClearAnimations();
-            ANI_PlayAnimationWithCallback(TRON_death_text_animation, TRON_draw_text, TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_DeathCallback, app);
+            ANI_PlayTextAnimationWithCallback(TRON_death_text_animation, TRON_text_atlas, "Draw !", TRON_GetLogicalCenter(), SDL_GetTicks(), TRON_DeathCallback, app);
             app->game_ended = true;
         }
     }
 }
 
+void TRON_RenderNetplay(TRON_AppState* app)
+{
+    Uint64 now = SDL_GetTicksNS();
+    if (NPL_UpdateSession(app->session, now)) { TRON_InvalidateTrails(app); }
+    app->state_time = NPL_GetTickTime(app->session);
+    if (NPL_IsRoundOver(app->session))
+    {
+        TRON_RenderDeathScreen(app);
+    }
+    else if (TRON_GetWorldTick(app->state) > app->rendered_tick)
+    {
+        TRON_PlayDeathAnimations(app);
+        app->rendered_tick = TRON_GetWorldTick(app->state);
+    }
+    TRON_RenderState(app, now);
+
+    char text[96] = "";
+    NPL_Stats stats = NPL_GetSessionStats(app->session);
+    if (!NPL_IsSessionReady(app->session)) { SDL_snprintf(text, sizeof(text), "waiting for players"); }
+    else if (stats.desync_tick >= 0) { SDL_snprintf(text, sizeof(text), "desync at tick %" SDL_PRIs64, stats.desync_tick); }
+    if (!text[0]) { return; }
+
+    SDL_FPoint size = TXT_GetTextSize(text);
+    SDL_FPoint center = {TRON_LOGICAL_WIDTH / 2.0f, TRON_LOGICAL_HEIGHT - size.y * TRON_REPLAY_SCALE};
+    TXT_AddText(TRON_text_atlas, app->queue, TRON_LAYER_STATS, text, center, (SDL_FPoint){TRON_REPLAY_SCALE, TRON_REPLAY_SCALE}, 0.0f, (SDL_Color){255, 255, 255, 255});
+}
+
+bool TRON_StartNetplay(TRON_AppState* app)
+{
+    int num_players = app->net_player;
+    for (int i = 0; i < TRON_MAX_BIKES; i++)
+    {
+        if (app->net_peers[i]) { num_players = SDL_max(num_players, i + 1); }
+    }
+
+    app->session = NPL_CreateSession(app->world, num_players, app->net_player - 1, app->net_port ? app->net_port : TRON_NET_PORT);
+    if (!app->session)
+    {
+        SDL_Log("Failed to start netplay: %s", SDL_GetError());
+        return false;
+    }
+    for (int i = 0; i < num_players; i++)
+    {
+        if (i == app->net_player - 1) { continue; }
+        if (!app->net_peers[i])
+        {
+            SDL_Log("Missing --net-peer for player %d", i + 1);
+            return false;
+        }
+        if (!NPL_SetPeer(app->session, i, app->net_peers[i]))
+        {
+            SDL_Log("Failed to add player %d: %s", i + 1, SDL_GetError());
+            return false;
+        }
+    }
+    NPL_SetConditions(app->session, app->net_conditions);
+    if (app->net_delay >= 0) { NPL_SetInputDelay(app->session, app->net_delay); }
+
+    app->num_bikes = num_players;
+    app->state = app->world;
+    app->state_time = SDL_GetTicksNS();
+    app->game_started = true;
+    app->hide_menu = true;
+    return true;
+}
+
+TRON_Direction TRON_GetLoopbackTurn(TRON_World* world, int bike)
+{
+    SDL_FPoint position = TRON_GetBikePosition(world, bike);
+    SDL_FPoint size = TRON_GetWorldSize(world);
+    TRON_Direction direction = TRON_GetBikeDirection(world, bike);
+    if ((direction == TRON_NORTH) || (direction == TRON_SOUTH)) { return position.x < size.x / 2.0f ? TRON_EAST : TRON_WEST; }
+
+    return position.y < size.y / 2.0f ? TRON_SOUTH : TRON_NORTH;
+}
+
+int TRON_CheckLoopback(NPL_Session* session, TRON_World* reference, int num_players)
+{
+    int mismatches = 0;
+    while (TRON_GetWorldTick(reference) < NPL_GetConfirmedTick(session))
+    {
+        Uint64 tick = TRON_GetWorldTick(reference) + 1;
+        for (int i = 0; i < num_players; i++)
+        {
+            TRON_Direction direction;
+            int fraction = 0;
+            if (NPL_GetConfirmedTurn(session, tick, i, &direction, &fraction)) { TRON_QueueTurn(reference, i, direction, fraction); }
+        }
+        TRON_StepWorld(reference);
+
+        Uint64 hash = 0;
+        if ((NPL_GetTickHash(session, tick, &hash)) && (hash != TRON_GetWorldHash(reference))) { mismatches++; }
+    }
+
+    return mismatches;
+}
+
+SDL_AppResult TRON_RunLoopback(TRON_AppState* app)
+{
+    int num_players = SDL_clamp(app->loopback_players, 2, NPL_MAX_PLAYERS);
+    Uint16 port = app->net_port ? app->net_port : TRON_NET_PORT;
+    TRON_World* worlds[NPL_MAX_PLAYERS] = {NULL};
+    TRON_World* references[NPL_MAX_PLAYERS] = {NULL};
+    NPL_Session* sessions[NPL_MAX_PLAYERS] = {NULL};
+    bool ok = true;
+
+    for (int i = 0; i < num_players; i++)
+    {
+        worlds[i] = TRON_CreateWorld(app->arena.x, app->arena.y, num_players);
+        references[i] = TRON_CreateWorld(app->arena.x, app->arena.y, num_players);
+        sessions[i] = NPL_CreateSession(worlds[i], num_players, i, port + i);
+        if (!sessions[i])
+        {
+            SDL_Log("Failed to start netplay for player %d: %s", i + 1, SDL_GetError());
+            ok = false;
+            continue;
+        }
+        NPL_SetConditions(sessions[i], app->net_conditions);
+        if (app->net_delay >= 0) { NPL_SetInputDelay(sessions[i], app->net_delay); }
+        for (int j = 0; j < num_players; j++)
+        {
+            char address[32];
+            SDL_snprintf(address, sizeof(address), "127.0.0.1:%d", port + j);
+            if ((j != i) && (!NPL_SetPeer(sessions[i], j, address))) { ok = false; }
+        }
+    }
+
+    int mismatches = 0;
+    bool over = false;
+    Uint64 random = port;
+    Uint64 now = SDL_NS_PER_SECOND;
+    Uint64 start = SDL_GetTicksNS();
+    for (int step = 0; (ok) && (!over) && (step < TRON_LOOPBACK_MAX_MS); step++, now += SDL_NS_PER_MS)
+    {
+        over = true;
+        for (int i = 0; i < num_players; i++)
+        {
+            NPL_UpdateSession(sessions[i], now);
+            if (SDL_rand_r(&random, TRON_LOOPBACK_TURN_ODDS) == 0) { NPL_PushTurn(sessions[i], TRON_GetLoopbackTurn(worlds[i], i), now); }
+            mismatches += TRON_CheckLoopback(sessions[i], references[i], num_players);
+            over = over && NPL_IsRoundOver(sessions[i]);
+        }
+    }
+    Uint64 elapsed = SDL_GetTicksNS() - start;
+
+    for (int i = 0; (ok) && (i < num_players); i++)
+    {
+        NPL_Stats stats = NPL_GetSessionStats(sessions[i]);
+        SDL_Log("Player %d: %" SDL_PRIu64 " ticks, %d alive, rollbacks %d (max %d, %d resimulated), stalled %d, packets %d sent %d dropped %d received",
+                i + 1, stats.confirmed_tick, TRON_CountAliveBikes(worlds[i]), stats.rollbacks, stats.max_rollback, stats.resimulated_ticks, stats.stalled_ticks, stats.sent_packets, stats.dropped_packets, stats.received_packets);
+        if (stats.desync_tick >= 0) { ok = false; }
+        if (TRON_GetWorldHash(worlds[i]) != TRON_GetWorldHash(worlds[0])) { ok = false; }
+    }
+    if (ok) { SDL_Log("Loopback %s in %.2f ms, %d mismatched ticks", over ? "finished" : "timed out", elapsed / 1e6, mismatches); }
+
+    for (int i = 0; i < num_players; i++)
+    {
+        NPL_DestroySession(sessions[i]);
+        TRON_DestroyWorld(worlds[i]);
+        TRON_DestroyWorld(references[i]);
+    }
+    return (ok) && (over) && (mismatches == 0) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+}
+
+void TRON_RenderWorldViews(TRON_AppState* app)
+{
+    SDL_FRect arena = {0.0f, 0.0f, app->arena.x, app->arena.y};
+    RND_AddRect(app->world_queue, TRON_LAYER_BACKGROUND, &arena, (SDL_Color){100, 100, 100, 255});
+
+    RND_View views[TRON_MAX_VIEWS];
+    for (int i = 0; i < app->num_views; i++) { views[i] = TRON_GetRenderView(&app->views[i]); }
+    RND_FlushViews(app->world_queue, views, app->num_views);
+}
+
+void TRON_RenderStats(TRON_AppState* app)
+{
+    if (!app->show_stats) { return; }
+
+    char text[96];
+    RND_Stats stats = app->render_stats;
+    SDL_snprintf(text, sizeof(text), "draws %d  states %d  triangles %d  commands %d", stats.draw_calls, stats.state_changes, stats.primitives, stats.commands);
+
+    SDL_FPoint size = TXT_GetTextSize(text);
+    SDL_FPoint center = {size.x * TRON_STATS_SCALE / 2.0f, size.y * TRON_STATS_SCALE / 2.0f};
+    TXT_AddText(TRON_text_atlas, app->queue, TRON_LAYER_STATS, text, center, (SDL_FPoint){TRON_STATS_SCALE, TRON_STATS_SCALE}, 0.0f, (SDL_Color){255, 255, 255, 255});
+}
+
+void TRON_ParseArguments(TRON_AppState* app, int argc, char* argv[])
+{
+    app->arena = (SDL_FPoint){TRON_LOGICAL_WIDTH, TRON_LOGICAL_HEIGHT};
+    app->net_delay = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((!SDL_strcmp(argv[i], "--latency-probe")) && (!app->latency_probe))
+        {
+            app->latency_probe = LAT_CreateProbe();
+        }
+        else if ((!SDL_strcmp(argv[i], "--arena-width")) && (i + 1 < argc))
+        {
+            app->arena.x = (float)SDL_atof(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--arena-height")) && (i + 1 < argc))
+        {
+            app->arena.y = (float)SDL_atof(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--record")) && (i + 1 < argc))
+        {
+            app->record_prefix = argv[++i];
+        }
+        else if ((!SDL_strcmp(argv[i], "--play")) && (i + 1 < argc))
+        {
+            app->play_path = argv[++i];
+        }
+        else if ((!SDL_strcmp(argv[i], "--replay")) && (i + 1 < argc))
+        {
+            app->replay_path = argv[++i];
+        }
+        else if ((!SDL_strcmp(argv[i], "--compare")) && (i + 2 < argc))
+        {
+            app->compare_paths[0] = argv[++i];
+            app->compare_paths[1] = argv[++i];
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-player")) && (i + 1 < argc))
+        {
+            int player = SDL_atoi(argv[++i]);
+            app->net_player = SDL_clamp(player, 1, TRON_MAX_BIKES);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-port")) && (i + 1 < argc))
+        {
+            app->net_port = (Uint16)SDL_atoi(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-peer")) && (i + 2 < argc))
+        {
+            int player = SDL_atoi(argv[++i]);
+            const char* address = argv[++i];
+            if ((player >= 1) && (player <= TRON_MAX_BIKES)) { app->net_peers[player - 1] = address; }
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-latency")) && (i + 1 < argc))
+        {
+            app->net_conditions.latency_ms = SDL_atoi(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-jitter")) && (i + 1 < argc))
+        {
+            app->net_conditions.jitter_ms = SDL_atoi(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-loss")) && (i + 1 < argc))
+        {
+            app->net_conditions.loss_percent = SDL_atoi(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-delay")) && (i + 1 < argc))
+        {
+            app->net_delay = SDL_atoi(argv[++i]);
+        }
+        else if ((!SDL_strcmp(argv[i], "--net-loopback")) && (i + 1 < argc))
+        {
+            app->loopback_players = SDL_atoi(argv[++i]);
+        }
+    }
+
+    app->arena.x = SDL_clamp(app->arena.x, TRON_MIN_ARENA_SIZE, TRON_MAX_ARENA_SIZE);
+    app->arena.y = SDL_clamp(app->arena.y, TRON_MIN_ARENA_SIZE, TRON_MAX_ARENA_SIZE);
+}
+
 SDL_AppResult SDL_AppInit(void** userdata, int argc, char* argv[])
 {
     TRON_AppState* app = SDL_calloc(1, sizeof(TRON_AppState));
+    *userdata = app;
+    TRON_ParseArguments(app, argc, argv);
+    if (app->play_path) { return TRON_PlayReplay(app->play_path); }
+    if (app->compare_paths[0]) { return TRON_CompareReplays(app->compare_paths); }
+    if (app->loopback_players) { return TRON_RunLoopback(app); }
+    if (app->replay_path)
+    {
+        app->replay = RPL_OpenReplay(app->replay_path);
+        if (!app->replay)
+        {
+            SDL_Log("Failed to open replay %s: %s", app->replay_path, SDL_GetError());
+            return SDL_APP_FAILURE;
+        }
+        app->arena = TRON_GetWorldSize(RPL_GetReplayWorld(app->replay));
+    }
+
     SDL_Init(SDL_INIT_VIDEO);
     SDL_CreateWindowAndRenderer("light bike", 960, 540, SDL_WINDOW_RESIZABLE, &app->window, &app->renderer);
     SDL_SetRenderLogicalPresentation(app->renderer, TRON_LOGICAL_WIDTH, TRON_LOGICAL_HEIGHT, SDL_LOGICAL_PRESENTATION_LETTERBOX);
-    SDL_SetHint(SDL_HINT_MAIN_CALLBACK_RATE, "60");
+    SDL_SetRenderVSync(app->renderer, 1);
 
     SDL_memcpy(app->keys, TRON_DEFAULT_KEYS, sizeof(TRON_DEFAULT_KEYS));
+    TRON_BuildKeyBindings(app);
     app->num_bikes = TRON_MAX_BIKES;
-    app->bikes = TRON_CreateBikes(app->renderer);
+    TRON_ResetViews(app);
+    app->split_screen = true;
+    app->world = TRON_CreateWorld(app->arena.x, app->arena.y, app->num_bikes);
+    app->simulation = SIM_CreateSimulation(app->world, app->latency_probe);
+    app->state = SIM_AcquireState(app->simulation, &app->state_time);
     app->game_started = false;
     app->game_ended = false;
     app->player_choice = 0;
+    if (app->replay)
+    {
+        app->state = RPL_GetReplayWorld(app->replay);
+        app->state_time = SDL_GetTicksNS();
+        app->num_bikes = SDL_min(RPL_GetReplayBikes(app->replay), TRON_MAX_BIKES);
+        app->game_started = true;
+        app->hide_menu = true;
+    }
+    else if ((app->net_player) && (!TRON_StartNetplay(app)))
+    {
+        return SDL_APP_FAILURE;
+    }
 
-    TRON_CreateTexts(app->renderer);
+    app->queue = RND_CreateQueue(app->renderer);
+    app->world_queue = RND_CreateQueue(app->renderer);
+    TRON_text_atlas = TXT_CreateAtlas(app->renderer);
+    if (TRON_ArenaFitsView(app))
+    {
+        TRON_CreateTrailLayer(app->renderer, &app->trail_layer, app->arena);
+    }
+    else
+    {
+        app->trail_index = TRL_CreateIndex(app->arena.x, app->arena.y);
+        app->minimap = MAP_CreateMinimap(app->renderer, app->arena.x, app->arena.y, TRON_MINIMAP_RESOLUTION, TRON_BIKE_COLORS, TRON_MAX_BIKES);
+    }
     TRON_death_text_animation = ANI_LoadAnimationFromConstMem(TRON_DEATH_TEXT_XML, SDL_strlen(TRON_DEATH_TEXT_XML));
     TRON_start_animation = ANI_LoadAnimationFromConstMem(TRON_START_XML, SDL_strlen(TRON_START_XML));
 
-    *userdata = app;
     return SDL_APP_CONTINUE;
 }
 
@@ -529,6 +1242,25 @@ SDL_AppResult SDL_AppEvent(void* userdata, SDL_Event* event)
     TRON_AppState* app = userdata;
 
     if (event->type == SDL_EVENT_QUIT) { return SDL_APP_SUCCESS; }
+
+    if (event->type == SDL_EVENT_RENDER_TARGETS_RESET)
+    {
+        app->trail_layer.dirty = true;
+        TXT_RestoreAtlas(TRON_text_atlas);
+    }
+    else if (event->type == SDL_EVENT_RENDER_DEVICE_RESET)
+    {
+        if (TRON_ArenaFitsView(app))
+        {
+            TRON_DestroyTrailLayer(&app->trail_layer);
+            TRON_CreateTrailLayer(app->renderer, &app->trail_layer, app->arena);
+        }
+        else if (app->minimap)
+        {
+            MAP_RestoreMinimap(app->minimap);
+        }
+        TXT_RestoreAtlas(TRON_text_atlas);
+    }
     
     if ((event->type == SDL_EVENT_KEY_DOWN) && (!event->key.repeat))
     {
@@ -536,14 +1268,27 @@ SDL_AppResult SDL_AppEvent(void* userdata, SDL_Event* event)
         {
             SDL_SetWindowFullscreen(app->window, !(SDL_GetWindowFlags(app->window) & SDL_WINDOW_FULLSCREEN));
         }
-        if (!app->game_started)
+        if (event->key.scancode == SDL_SCANCODE_F3)
         {
-            if (!TRON_MenuKeyDown(app, event)) { return SDL_APP_SUCCESS; }
+            app->show_stats = !app->show_stats;
         }
-        else if (TRON_CountAliveBikes(app->bikes, app->num_bikes) == 1)
+        if (event->key.scancode == SDL_SCANCODE_F4)
         {
+            app->split_screen = !app->split_screen;
         }
-        else
+        if (app->replay)
+        {
+            TRON_ReplayKeyDown(app, event);
+        }
+        else if (app->session)
+        {
+            TRON_NetplayKeyDown(app, event);
+        }
+        else if (!app->game_started)
+        {
+            if (!TRON_MenuKeyDown(app, event)) { return SDL_APP_SUCCESS; }
+        }
+        else if (SIM_IsSimulationRunning(app->simulation))
         {
             TRON_GameplayKeyDown(app, event);
         }
@@ -558,23 +1303,41 @@ SDL_AppResult SDL_AppIterate(void* userdata)
 
     SDL_SetRenderDrawColor(app->renderer, 0, 0, 0, 255);
     SDL_RenderClear(app->renderer);
-    SDL_SetRenderDrawColor(app->renderer, 100, 100, 100, 255);
-    SDL_RenderFillRect(app->renderer, NULL);
-    ANI_RenderAnimations(app->renderer, SDL_GetTicks());
+    ANI_RenderAnimations(app->queue, TRON_LAYER_ANIMATIONS, SDL_GetTicks());
 
-    if (!app->game_started)
+    if (app->replay)
+    {
+        TRON_RenderReplay(app);
+    }
+    else if (app->session)
+    {
+        TRON_RenderNetplay(app);
+    }
+    else if (!app->game_started)
     {
         TRON_RenderMenu(app);
     }
-    else if (TRON_CountAliveBikes(app->bikes, app->num_bikes) <= 1)
+    else if (TRON_CountAliveBikes(app->state) <= 1)
     {
+        SIM_StopSimulation(app->simulation);
+        TRON_FinishRecording(app);
         TRON_RenderDeathScreen(app);
     }
     else
     {
         TRON_RenderGame(app);
     }
+    TRON_RenderWorldViews(app);
+    TRON_RenderStats(app);
+    RND_Flush(app->queue);
     SDL_RenderPresent(app->renderer);
+    if (app->latency_probe) { LAT_PresentInputs(app->latency_probe, TRON_GetWorldTick(app->state), SDL_GetTicksNS()); }
+
+    RND_Stats world_stats = RND_GetStats(app->world_queue);
+    RND_Stats screen_stats = RND_GetStats(app->queue);
+    app->render_stats = (RND_Stats){world_stats.draw_calls + screen_stats.draw_calls, world_stats.state_changes + screen_stats.state_changes, world_stats.primitives + screen_stats.primitives, world_stats.commands + screen_stats.commands};
+    RND_ResetStats(app->world_queue);
+    RND_ResetStats(app->queue);
 
     return SDL_APP_CONTINUE;
 }
@@ -583,10 +1346,21 @@ void SDL_AppQuit(void* userdata, SDL_AppResult result)
 {
     TRON_AppState* app = userdata;
 
-    TRON_DestroyTexts();
+    TXT_DestroyAtlas(TRON_text_atlas);
     ANI_ClearAnimations();
     ANI_DestroyAnimation(TRON_death_text_animation);
     ANI_DestroyAnimation(TRON_start_animation);
-    TRON_DestroyBikes(app->bikes);
+    TRON_FinishRecording(app);
+    SIM_DestroySimulation(app->simulation);
+    TRON_DestroyWorld(app->world);
+    RPL_CloseReplay(app->replay);
+    NPL_DestroySession(app->session);
+    RND_DestroyQueue(app->queue);
+    RND_DestroyQueue(app->world_queue);
+    TRON_DestroyTrailLayer(&app->trail_layer);
+    TRL_DestroyIndex(app->trail_index);
+    MAP_DestroyMinimap(app->minimap);
+    if (app->latency_probe) { LAT_LogReport(app->latency_probe); }
+    LAT_DestroyProbe(app->latency_probe);
     SDL_free(app);
 }
@@ -0,0 +1,299 @@
+#include "minimap.h"
+
+#define MAP_MAX_COLORS 16
+
+struct MAP_Minimap
+{
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    int width;
+    int height;
+    float scale;
+
+    Uint32* pixels;
+    bool* dirty_rows;
+    bool* erased_rows;
+    int first_dirty;
+    int last_dirty;
+
+    Uint32 colors[MAP_MAX_COLORS];
+    int num_colors;
+
+    int* heads;
+    SDL_Point* points;
+    bool* dead;
+    int bike_capacity;
+    int num_segments;
+};
+
+bool MAP_CreateMinimapTexture(MAP_Minimap* minimap)
+{
+    minimap->texture = SDL_CreateTexture(minimap->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, minimap->width, minimap->height);
+    if (!minimap->texture) { return false; }
+
+    SDL_SetTextureBlendMode(minimap->texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(minimap->texture, SDL_SCALEMODE_NEAREST);
+    minimap->first_dirty = 0;
+    minimap->last_dirty = minimap->height - 1;
+    for (int i = 0; i < minimap->height; i++) { minimap->dirty_rows[i] = true; }
+    return true;
+}
+
+MAP_Minimap* MAP_CreateMinimap(SDL_Renderer* renderer, float width, float height, int size, const SDL_Color* colors, int num_colors)
+{
+    MAP_Minimap* minimap = SDL_calloc(1, sizeof(MAP_Minimap));
+    minimap->renderer = renderer;
+    minimap->scale = SDL_max(width, height) / size;
+    minimap->width = SDL_max((int)SDL_ceilf(width / minimap->scale), 1);
+    minimap->height = SDL_max((int)SDL_ceilf(height / minimap->scale), 1);
+    minimap->pixels = SDL_calloc(minimap->width * minimap->height, sizeof(Uint32));
+    minimap->dirty_rows = SDL_calloc(minimap->height, sizeof(bool));
+    minimap->erased_rows = SDL_calloc(minimap->height, sizeof(bool));
+
+    const SDL_PixelFormatDetails* format = SDL_GetPixelFormatDetails(SDL_PIXELFORMAT_RGBA32);
+    minimap->num_colors = SDL_min(num_colors, MAP_MAX_COLORS);
+    for (int i = 0; i < minimap->num_colors; i++)
+    {
+        minimap->colors[i] = SDL_MapRGBA(format, NULL, colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+    }
+
+    if (!MAP_CreateMinimapTexture(minimap))
+    {
+        MAP_DestroyMinimap(minimap);
+        return NULL;
+    }
+    MAP_ClearMinimap(minimap);
+
+    return minimap;
+}
+
+void MAP_DestroyMinimap(MAP_Minimap* minimap)
+{
+    if (!minimap) { return; }
+
+    SDL_DestroyTexture(minimap->texture);
+    SDL_free(minimap->pixels);
+    SDL_free(minimap->dirty_rows);
+    SDL_free(minimap->erased_rows);
+    SDL_free(minimap->heads);
+    SDL_free(minimap->points);
+    SDL_free(minimap->dead);
+    SDL_free(minimap);
+}
+
+bool MAP_RestoreMinimap(MAP_Minimap* minimap)
+{
+    SDL_DestroyTexture(minimap->texture);
+    minimap->texture = NULL;
+    return MAP_CreateMinimapTexture(minimap);
+}
+
+void MAP_MarkRows(MAP_Minimap* minimap, int first, int last)
+{
+    for (int i = first; i <= last; i++) { minimap->dirty_rows[i] = true; }
+    minimap->first_dirty = SDL_min(minimap->first_dirty, first);
+    minimap->last_dirty = SDL_max(minimap->last_dirty, last);
+}
+
+void MAP_ClearMinimap(MAP_Minimap* minimap)
+{
+    SDL_memset(minimap->pixels, 0, minimap->width * minimap->height * sizeof(Uint32));
+    MAP_MarkRows(minimap, 0, minimap->height - 1);
+
+    if (minimap->heads) { SDL_memset(minimap->heads, 0xFF, minimap->bike_capacity * sizeof(int)); }
+    if (minimap->dead) { SDL_memset(minimap->dead, 0, minimap->bike_capacity * sizeof(bool)); }
+    minimap->num_segments = 0;
+}
+
+void MAP_ReserveBikes(MAP_Minimap* minimap, int capacity)
+{
+    if (capacity <= minimap->bike_capacity) { return; }
+
+    minimap->heads = SDL_realloc(minimap->heads, capacity * sizeof(int));
+    minimap->points = SDL_realloc(minimap->points, capacity * sizeof(SDL_Point));
+    minimap->dead = SDL_realloc(minimap->dead, capacity * sizeof(bool));
+    SDL_memset(minimap->heads + minimap->bike_capacity, 0xFF, (capacity - minimap->bike_capacity) * sizeof(int));
+    SDL_memset(minimap->dead + minimap->bike_capacity, 0, (capacity - minimap->bike_capacity) * sizeof(bool));
+    minimap->bike_capacity = capacity;
+}
+
+SDL_Rect MAP_GetSegmentArea(MAP_Minimap* minimap, SDL_Point from, SDL_Point to)
+{
+    SDL_FPoint start = TRON_GetFloatPoint(from);
+    SDL_FPoint end = TRON_GetFloatPoint(to);
+    float half = TRON_TRAIL_SIZE / 2.0f;
+    int x1 = SDL_clamp((int)((SDL_min(start.x, end.x) - half) / minimap->scale), 0, minimap->width - 1);
+    int y1 = SDL_clamp((int)((SDL_min(start.y, end.y) - half) / minimap->scale), 0, minimap->height - 1);
+    int x2 = SDL_clamp((int)((SDL_max(start.x, end.x) + half) / minimap->scale), 0, minimap->width - 1);
+    int y2 = SDL_clamp((int)((SDL_max(start.y, end.y) + half) / minimap->scale), 0, minimap->height - 1);
+
+    return (SDL_Rect){x1, y1, x2 - x1 + 1, y2 - y1 + 1};
+}
+
+void MAP_FillRow(MAP_Minimap* minimap, const SDL_Rect* area, int y, Uint32 color)
+{
+    Uint32* row = minimap->pixels + y * minimap->width;
+    for (int x = area->x; x < area->x + area->w; x++) { row[x] = color; }
+}
+
+void MAP_Stamp(MAP_Minimap* minimap, SDL_Point from, SDL_Point to, int owner)
+{
+    SDL_Rect area = MAP_GetSegmentArea(minimap, from, to);
+    Uint32 color = minimap->colors[owner % minimap->num_colors];
+
+    for (int y = area.y; y < area.y + area.h; y++) { MAP_FillRow(minimap, &area, y, color); }
+    MAP_MarkRows(minimap, area.y, area.y + area.h - 1);
+}
+
+void MAP_Erase(MAP_Minimap* minimap, SDL_Point from, SDL_Point to)
+{
+    SDL_Rect area = MAP_GetSegmentArea(minimap, from, to);
+
+    for (int y = area.y; y < area.y + area.h; y++)
+    {
+        MAP_FillRow(minimap, &area, y, 0);
+        minimap->erased_rows[y] = true;
+    }
+    MAP_MarkRows(minimap, area.y, area.y + area.h - 1);
+}
+
+void MAP_Restamp(MAP_Minimap* minimap, SDL_Point from, SDL_Point to, int owner)
+{
+    SDL_Rect area = MAP_GetSegmentArea(minimap, from, to);
+    Uint32 color = minimap->colors[owner % minimap->num_colors];
+
+    for (int y = area.y; y < area.y + area.h; y++)
+    {
+        if (minimap->erased_rows[y]) { MAP_FillRow(minimap, &area, y, color); }
+    }
+}
+
+SDL_Point MAP_GetStampedEnd(MAP_Minimap* minimap, TRON_Segments* segments, int segment)
+{
+    int owner = segments->owners[segment];
+    SDL_Point start = segments->starts[segment];
+    SDL_Point end = segments->ends[segment];
+    SDL_Point point = minimap->points[owner];
+    if (segment != minimap->heads[owner]) { return end; }
+
+    bool further = SDL_abs(point.x - start.x) + SDL_abs(point.y - start.y) > SDL_abs(end.x - start.x) + SDL_abs(end.y - start.y);
+    return further ? point : end;
+}
+
+bool MAP_HasRevivedBikes(MAP_Minimap* minimap, TRON_World* world)
+{
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        if ((minimap->dead[i]) && (!TRON_IsBikeDead(world, i))) { return true; }
+    }
+    return false;
+}
+
+void MAP_EraseDeadBikes(MAP_Minimap* minimap, TRON_World* world)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+    bool erased = false;
+
+    for (int i = 0; i < minimap->num_segments; i++)
+    {
+        int owner = segments.owners[i];
+        if ((minimap->dead[owner]) || (!TRON_IsBikeDead(world, owner))) { continue; }
+
+        MAP_Erase(minimap, segments.starts[i], MAP_GetStampedEnd(minimap, &segments, i));
+        erased = true;
+    }
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        if ((!minimap->dead[i]) && (TRON_IsBikeDead(world, i))) { minimap->heads[i] = -1; }
+        minimap->dead[i] = TRON_IsBikeDead(world, i);
+    }
+    if (!erased) { return; }
+
+    for (int i = 0; i < minimap->num_segments; i++)
+    {
+        int owner = segments.owners[i];
+        if (minimap->dead[owner]) { continue; }
+
+        MAP_Restamp(minimap, segments.starts[i], MAP_GetStampedEnd(minimap, &segments, i), owner);
+    }
+    SDL_memset(minimap->erased_rows, 0, minimap->height * sizeof(bool));
+}
+
+void MAP_ExtendHeads(MAP_Minimap* minimap, TRON_World* world)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        int head = minimap->heads[i];
+        if (head < 0) { continue; }
+
+        MAP_Stamp(minimap, minimap->points[i], segments.ends[head], i);
+        minimap->points[i] = segments.ends[head];
+        if ((head != TRON_GetBikeHeadSegment(world, i)) || (TRON_IsBikeDead(world, i))) { minimap->heads[i] = -1; }
+    }
+}
+
+void MAP_AddNewSegments(MAP_Minimap* minimap, TRON_World* world)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+
+    for (int i = minimap->num_segments; i < segments.count; i++)
+    {
+        int owner = segments.owners[i];
+        if (TRON_IsBikeDead(world, owner)) { continue; }
+
+        MAP_Stamp(minimap, segments.starts[i], segments.ends[i], owner);
+        if (i == TRON_GetBikeHeadSegment(world, owner))
+        {
+            minimap->heads[owner] = i;
+            minimap->points[owner] = segments.ends[i];
+        }
+    }
+    minimap->num_segments = segments.count;
+}
+
+void MAP_UploadRows(MAP_Minimap* minimap)
+{
+    int first = -1;
+    for (int y = minimap->first_dirty; y <= minimap->last_dirty + 1; y++)
+    {
+        bool dirty = (y <= minimap->last_dirty) && (minimap->dirty_rows[y]);
+        if ((dirty) && (first < 0)) { first = y; }
+        if ((!dirty) && (first >= 0))
+        {
+            SDL_Rect rect = {0, first, minimap->width, y - first};
+            SDL_UpdateTexture(minimap->texture, &rect, minimap->pixels + first * minimap->width, minimap->width * sizeof(Uint32));
+            first = -1;
+        }
+        if (dirty) { minimap->dirty_rows[y] = false; }
+    }
+
+    minimap->first_dirty = minimap->height;
+    minimap->last_dirty = -1;
+}
+
+void MAP_UpdateMinimap(MAP_Minimap* minimap, TRON_World* world)
+{
+    MAP_ReserveBikes(minimap, TRON_GetNumBikes(world));
+    if ((TRON_GetSegments(world).count < minimap->num_segments) || (MAP_HasRevivedBikes(minimap, world)))
+    {
+        MAP_ClearMinimap(minimap);
+    }
+
+    MAP_EraseDeadBikes(minimap, world);
+    MAP_ExtendHeads(minimap, world);
+    MAP_AddNewSegments(minimap, world);
+    MAP_UploadRows(minimap);
+}
+
+SDL_FPoint MAP_GetMinimapSize(MAP_Minimap* minimap)
+{
+    return (SDL_FPoint){(float)minimap->width, (float)minimap->height};
+}
+
+void MAP_AddMinimap(MAP_Minimap* minimap, RND_Queue* queue, int layer, const SDL_FRect* rect)
+{
+    SDL_FRect uv = {0.0f, 0.0f, 1.0f, 1.0f};
+    RND_AddRotatedQuad(queue, layer, minimap->texture, rect, &uv, (SDL_FPoint){0.0f, 0.0f}, 0.0f, (SDL_FColor){1.0f, 1.0f, 1.0f, 1.0f});
+}
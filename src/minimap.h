@@ -0,0 +1,21 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_render.h>
+#include "render.h"
+#include "tron.h"
+
+typedef struct MAP_Minimap MAP_Minimap;
+
+MAP_Minimap* MAP_CreateMinimap(SDL_Renderer* renderer, float width, float height, int size, const SDL_Color* colors, int num_colors);
+
+void MAP_DestroyMinimap(MAP_Minimap* minimap);
+
+bool MAP_RestoreMinimap(MAP_Minimap* minimap);
+
+void MAP_ClearMinimap(MAP_Minimap* minimap);
+
+void MAP_UpdateMinimap(MAP_Minimap* minimap, TRON_World* world);
+
+SDL_FPoint MAP_GetMinimapSize(MAP_Minimap* minimap);
+
+void MAP_AddMinimap(MAP_Minimap* minimap, RND_Queue* queue, int layer, const SDL_FRect* rect);
@@ -0,0 +1,684 @@
+#include "netplay.h"
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+#ifdef SDL_PLATFORM_WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NPL_Socket;
+#define NPL_INVALID_SOCKET INVALID_SOCKET
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NPL_Socket;
+#define NPL_INVALID_SOCKET -1
+#endif
+
+#define NPL_MAGIC 0x4E504C54u
+#define NPL_TICK_NS (SDL_NS_PER_SECOND / TRON_TICK_RATE)
+#define NPL_WINDOW 128
+#define NPL_MAX_ROLLBACK 32
+#define NPL_DEFAULT_INPUT_DELAY 2
+#define NPL_MAX_INPUT_DELAY 16
+#define NPL_MAX_CATCH_UP_TICKS 8
+#define NPL_SYNC_INTERVAL 30
+#define NPL_MAX_SKIP 4
+#define NPL_MAX_PACKET_INPUTS 96
+#define NPL_MAX_PACKET_SIZE 512
+#define NPL_MAX_DELAYED 512
+#define NPL_MAX_RECEIVES 256
+#define NPL_TURN_FLAG 0x8000
+
+typedef struct NPL_Peer
+{
+    bool active;
+    struct sockaddr_in address;
+    bool heard;
+    bool finished;
+    Uint64 received;
+    Uint64 acked;
+    Uint64 remote_tick;
+    int remote_advantage;
+    Uint64 check_tick;
+    Uint64 check_hash;
+    bool checked;
+}NPL_Peer;
+
+typedef struct NPL_Packet
+{
+    Uint64 due;
+    int peer;
+    int size;
+    Uint8 data[NPL_MAX_PACKET_SIZE];
+}NPL_Packet;
+
+struct NPL_Session
+{
+    TRON_World* world;
+    NPL_Socket socket;
+    int num_players;
+    int local_player;
+    int input_delay;
+    NPL_Peer peers[NPL_MAX_PLAYERS];
+    NPL_Conditions conditions;
+    Uint64 random;
+
+    Uint32 round;
+    Uint64 id;
+    bool running;
+    Uint64 tick;
+    Uint64 tick_time;
+    Uint64 confirmed;
+    Uint64 end_tick;
+    Uint64 rollback_tick;
+    Uint64 last_turn_tick;
+    Uint64 sync_tick;
+    int skip;
+    Uint64 send_time;
+
+    Uint16 inputs[NPL_WINDOW][NPL_MAX_PLAYERS];
+    Uint64 input_ticks[NPL_WINDOW][NPL_MAX_PLAYERS];
+    Uint16 used[NPL_WINDOW][NPL_MAX_PLAYERS];
+    TRON_Snapshot* snapshots[NPL_WINDOW];
+    Uint64 hashes[NPL_WINDOW];
+    int alive[NPL_WINDOW];
+
+    NPL_Packet* delayed;
+    int num_delayed;
+
+    NPL_Stats stats;
+    bool mismatch_logged;
+};
+
+void NPL_CloseSocket(NPL_Socket socket)
+{
+#ifdef SDL_PLATFORM_WINDOWS
+    closesocket(socket);
+    WSACleanup();
+#else
+    close(socket);
+#endif
+}
+
+NPL_Socket NPL_OpenSocket(Uint16 port)
+{
+#ifdef SDL_PLATFORM_WINDOWS
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        SDL_SetError("Couldn't start Winsock");
+        return NPL_INVALID_SOCKET;
+    }
+#endif
+
+    struct sockaddr_in address;
+    SDL_zero(address);
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    NPL_Socket result = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef SDL_PLATFORM_WINDOWS
+    u_long nonblocking = 1;
+    bool ok = (result != NPL_INVALID_SOCKET) && (bind(result, (struct sockaddr*)&address, sizeof(address)) == 0) && (ioctlsocket(result, FIONBIO, &nonblocking) == 0);
+#else
+    bool ok = (result != NPL_INVALID_SOCKET) && (bind(result, (struct sockaddr*)&address, sizeof(address)) == 0) && (fcntl(result, F_SETFL, fcntl(result, F_GETFL, 0) | O_NONBLOCK) == 0);
+#endif
+    if (!ok)
+    {
+        NPL_CloseSocket(result);
+        SDL_SetError("Couldn't open UDP port %d", port);
+        return NPL_INVALID_SOCKET;
+    }
+
+    return result;
+}
+
+bool NPL_WouldBlock(void)
+{
+#ifdef SDL_PLATFORM_WINDOWS
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+#endif
+}
+
+bool NPL_ResolveAddress(const char* text, struct sockaddr_in* address)
+{
+    char host[256];
+    const char* colon = SDL_strrchr(text, ':');
+    if ((!colon) || (colon == text) || (colon - text >= (ptrdiff_t)sizeof(host))) { return SDL_SetError("Expected host:port, got %s", text); }
+    SDL_strlcpy(host, text, colon - text + 1);
+
+    struct addrinfo hints;
+    SDL_zero(hints);
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = NULL;
+    if ((getaddrinfo(host, colon + 1, &hints, &result) != 0) || (!result)) { return SDL_SetError("Couldn't resolve %s", text); }
+
+    SDL_memcpy(address, result->ai_addr, sizeof(*address));
+    freeaddrinfo(result);
+    return true;
+}
+
+Uint16 NPL_GetInput(NPL_Session* session, int player, Uint64 tick)
+{
+    int slot = tick % NPL_WINDOW;
+    return session->input_ticks[slot][player] == tick ? session->inputs[slot][player] : 0;
+}
+
+void NPL_SetInput(NPL_Session* session, int player, Uint64 tick, Uint16 input)
+{
+    int slot = tick % NPL_WINDOW;
+    session->inputs[slot][player] = input;
+    session->input_ticks[slot][player] = tick;
+}
+
+void NPL_ResetRound(NPL_Session* session)
+{
+    TRON_ResetWorld(session->world, session->num_players);
+    TRON_SaveSnapshot(session->world, session->snapshots[0]);
+    session->id = TRON_GetWorldHash(session->world);
+    session->hashes[0] = session->id;
+    session->alive[0] = TRON_CountAliveBikes(session->world);
+
+    session->running = false;
+    session->tick = 0;
+    session->confirmed = 0;
+    session->end_tick = 0;
+    session->rollback_tick = 0;
+    session->last_turn_tick = 0;
+    session->sync_tick = 0;
+    session->skip = 0;
+    session->send_time = 0;
+    SDL_memset(session->inputs, 0, sizeof(session->inputs));
+    SDL_memset(session->input_ticks, 0, sizeof(session->input_ticks));
+    SDL_memset(session->used, 0, sizeof(session->used));
+
+    for (int i = 0; i < session->num_players; i++)
+    {
+        NPL_Peer* peer = &session->peers[i];
+        peer->heard = false;
+        peer->finished = false;
+        peer->received = 0;
+        peer->acked = 0;
+        peer->remote_tick = 0;
+        peer->remote_advantage = 0;
+        peer->check_tick = 0;
+        peer->checked = true;
+    }
+    session->stats = (NPL_Stats){0};
+    session->stats.desync_tick = -1;
+}
+
+NPL_Session* NPL_CreateSession(TRON_World* world, int num_players, int local_player, Uint16 port)
+{
+    if ((num_players < 2) || (num_players > NPL_MAX_PLAYERS) || (local_player < 0) || (local_player >= num_players))
+    {
+        SDL_SetError("Netplay needs 2 to %d players", NPL_MAX_PLAYERS);
+        return NULL;
+    }
+
+    NPL_Socket socket = NPL_OpenSocket(port);
+    if (socket == NPL_INVALID_SOCKET) { return NULL; }
+
+    NPL_Session* session = SDL_calloc(1, sizeof(NPL_Session));
+    session->world = world;
+    session->socket = socket;
+    session->num_players = num_players;
+    session->local_player = local_player;
+    session->input_delay = NPL_DEFAULT_INPUT_DELAY;
+    session->random = SDL_GetTicksNS() ^ ((Uint64)port << 32);
+    session->delayed = SDL_calloc(NPL_MAX_DELAYED, sizeof(NPL_Packet));
+    for (int i = 0; i < NPL_WINDOW; i++) { session->snapshots[i] = TRON_CreateSnapshot(); }
+    session->round = 1;
+    NPL_ResetRound(session);
+
+    return session;
+}
+
+void NPL_DestroySession(NPL_Session* session)
+{
+    if (!session) { return; }
+
+    NPL_CloseSocket(session->socket);
+    for (int i = 0; i < NPL_WINDOW; i++) { TRON_DestroySnapshot(session->snapshots[i]); }
+    SDL_free(session->delayed);
+    SDL_free(session);
+}
+
+bool NPL_SetPeer(NPL_Session* session, int player, const char* address)
+{
+    if ((player < 0) || (player >= session->num_players) || (player == session->local_player)) { return SDL_SetError("Invalid netplay player %d", player + 1); }
+
+    NPL_Peer* peer = &session->peers[player];
+    if (!NPL_ResolveAddress(address, &peer->address)) { return false; }
+    peer->active = true;
+
+    return true;
+}
+
+void NPL_SetConditions(NPL_Session* session, NPL_Conditions conditions)
+{
+    session->conditions.latency_ms = SDL_max(conditions.latency_ms, 0);
+    session->conditions.jitter_ms = SDL_max(conditions.jitter_ms, 0);
+    session->conditions.loss_percent = SDL_clamp(conditions.loss_percent, 0, 100);
+}
+
+void NPL_SetInputDelay(NPL_Session* session, int ticks)
+{
+    session->input_delay = SDL_clamp(ticks, 0, NPL_MAX_INPUT_DELAY);
+}
+
+void NPL_RestartSession(NPL_Session* session)
+{
+    session->round++;
+    NPL_ResetRound(session);
+}
+
+bool NPL_PushTurn(NPL_Session* session, TRON_Direction direction, Uint64 timestamp)
+{
+    if ((!session->running) || (session->end_tick)) { return false; }
+
+    Uint64 next = session->tick + 1 + session->input_delay;
+    Uint64 tick = SDL_max(next, session->last_turn_tick + 1);
+    if (tick >= session->confirmed + NPL_WINDOW) { return false; }
+
+    int fraction = 0;
+    if ((tick == next) && (timestamp > session->tick_time))
+    {
+        fraction = (int)SDL_min((timestamp - session->tick_time) * TRON_TURN_FRACTION_STEPS / NPL_TICK_NS, TRON_TURN_FRACTION_STEPS - 1);
+    }
+    NPL_SetInput(session, session->local_player, tick, NPL_TURN_FLAG | ((direction & 3) << 8) | fraction);
+    session->last_turn_tick = tick;
+
+    return true;
+}
+
+void NPL_SendPacket(NPL_Session* session, int player, const Uint8* data, int size)
+{
+    const NPL_Peer* peer = &session->peers[player];
+    sendto(session->socket, (const char*)data, size, 0, (const struct sockaddr*)&peer->address, sizeof(peer->address));
+}
+
+void NPL_QueuePacket(NPL_Session* session, int player, const Uint8* data, int size, Uint64 now)
+{
+    const NPL_Conditions* conditions = &session->conditions;
+    session->stats.sent_packets++;
+    if ((conditions->loss_percent > 0) && (SDL_rand_r(&session->random, 100) < conditions->loss_percent))
+    {
+        session->stats.dropped_packets++;
+        return;
+    }
+    if ((conditions->latency_ms == 0) && (conditions->jitter_ms == 0))
+    {
+        NPL_SendPacket(session, player, data, size);
+        return;
+    }
+    if (session->num_delayed == NPL_MAX_DELAYED)
+    {
+        session->stats.dropped_packets++;
+        return;
+    }
+
+    int jitter = conditions->jitter_ms > 0 ? SDL_rand_r(&session->random, 2 * conditions->jitter_ms + 1) - conditions->jitter_ms : 0;
+    NPL_Packet* packet = &session->delayed[session->num_delayed++];
+    packet->due = now + SDL_max(conditions->latency_ms + jitter, 0) * SDL_NS_PER_MS;
+    packet->peer = player;
+    packet->size = size;
+    SDL_memcpy(packet->data, data, size);
+}
+
+void NPL_FlushPackets(NPL_Session* session, Uint64 now)
+{
+    int count = 0;
+    for (int i = 0; i < session->num_delayed; i++)
+    {
+        NPL_Packet* packet = &session->delayed[i];
+        if (packet->due <= now) { NPL_SendPacket(session, packet->peer, packet->data, packet->size); }
+        else if (count++ != i) { session->delayed[count - 1] = *packet; }
+    }
+    session->num_delayed = count;
+}
+
+void NPL_SendInputs(NPL_Session* session, Uint64 now)
+{
+    Uint64 horizon = session->tick + session->input_delay;
+    Uint64 check_hash = session->hashes[session->confirmed % NPL_WINDOW];
+
+    for (int i = 0; i < session->num_players; i++)
+    {
+        NPL_Peer* peer = &session->peers[i];
+        if (!peer->active) { continue; }
+
+        Uint64 first = peer->acked + 1;
+        int count = horizon >= first ? (int)SDL_min(horizon - first + 1, NPL_MAX_PACKET_INPUTS) : 0;
+        Sint64 advantage = (Sint64)session->tick - (Sint64)peer->remote_tick;
+
+        Uint8 data[NPL_MAX_PACKET_SIZE];
+        SDL_IOStream* stream = SDL_IOFromMem(data, sizeof(data));
+        if (!stream) { return; }
+
+        SDL_WriteU32LE(stream, NPL_MAGIC);
+        SDL_WriteU32LE(stream, session->round);
+        SDL_WriteU64LE(stream, session->id);
+        SDL_WriteU8(stream, session->local_player);
+        SDL_WriteU32LE(stream, (Uint32)session->tick);
+        SDL_WriteU32LE(stream, (Uint32)peer->received);
+        SDL_WriteU16LE(stream, (Uint16)(Sint16)SDL_clamp(advantage, -32768, 32767));
+        SDL_WriteU32LE(stream, (Uint32)session->confirmed);
+        SDL_WriteU64LE(stream, check_hash);
+        SDL_WriteU32LE(stream, (Uint32)first);
+        SDL_WriteU8(stream, count);
+        for (int k = 0; k < count; k++)
+        {
+            SDL_WriteU16LE(stream, NPL_GetInput(session, session->local_player, first + k));
+        }
+        int size = (int)SDL_TellIO(stream);
+        SDL_CloseIO(stream);
+
+        NPL_QueuePacket(session, i, data, size, now);
+    }
+}
+
+void NPL_ReadInputs(NPL_Session* session, int player, SDL_IOStream* stream, Uint64 first, int count)
+{
+    NPL_Peer* peer = &session->peers[player];
+    if (first > peer->received + 1) { return; }
+
+    for (int k = 0; k < count; k++)
+    {
+        Uint16 input = 0;
+        Uint64 tick = first + k;
+        if (!SDL_ReadU16LE(stream, &input)) { return; }
+        if (tick <= peer->received) { continue; }
+        if (tick >= session->confirmed + NPL_WINDOW) { return; }
+
+        NPL_SetInput(session, player, tick, input);
+        peer->received = tick;
+        if ((tick <= session->tick) && (session->used[tick % NPL_WINDOW][player] != input) && ((!session->rollback_tick) || (tick < session->rollback_tick)))
+        {
+            session->rollback_tick = tick;
+        }
+    }
+}
+
+void NPL_ReadPacket(NPL_Session* session, const Uint8* data, int size)
+{
+    SDL_IOStream* stream = SDL_IOFromConstMem(data, size);
+    if (!stream) { return; }
+
+    Uint32 magic = 0;
+    Uint32 round = 0;
+    Uint64 id = 0;
+    Uint8 player = 0;
+    Uint32 tick = 0;
+    Uint32 ack = 0;
+    Uint16 advantage = 0;
+    Uint32 check_tick = 0;
+    Uint64 check_hash = 0;
+    Uint32 first = 0;
+    Uint8 count = 0;
+    bool ok = SDL_ReadU32LE(stream, &magic) && (magic == NPL_MAGIC) && SDL_ReadU32LE(stream, &round) && SDL_ReadU64LE(stream, &id) &&
+              SDL_ReadU8(stream, &player) && SDL_ReadU32LE(stream, &tick) && SDL_ReadU32LE(stream, &ack) && SDL_ReadU16LE(stream, &advantage) &&
+              SDL_ReadU32LE(stream, &check_tick) && SDL_ReadU64LE(stream, &check_hash) && SDL_ReadU32LE(stream, &first) && SDL_ReadU8(stream, &count);
+
+    NPL_Peer* peer = (ok) && (player < session->num_players) && (player != session->local_player) ? &session->peers[player] : NULL;
+    if ((!peer) || (!peer->active) || (round < session->round))
+    {
+        SDL_CloseIO(stream);
+        return;
+    }
+    if (round > session->round)
+    {
+        peer->finished = true;
+        SDL_CloseIO(stream);
+        return;
+    }
+    if (id != session->id)
+    {
+        if (!session->mismatch_logged) { SDL_Log("Player %d is playing a different arena, ignoring", player + 1); }
+        session->mismatch_logged = true;
+        SDL_CloseIO(stream);
+        return;
+    }
+
+    session->stats.received_packets++;
+    peer->heard = true;
+    peer->acked = SDL_max(peer->acked, ack);
+    if (tick >= peer->remote_tick)
+    {
+        peer->remote_tick = tick;
+        peer->remote_advantage = (Sint16)advantage;
+    }
+    if (check_tick > peer->check_tick)
+    {
+        peer->check_tick = check_tick;
+        peer->check_hash = check_hash;
+        peer->checked = false;
+    }
+    if ((first > 0) && (session->running)) { NPL_ReadInputs(session, player, stream, first, count); }
+    SDL_CloseIO(stream);
+}
+
+void NPL_ReceivePackets(NPL_Session* session)
+{
+    Uint8 data[NPL_MAX_PACKET_SIZE];
+
+    for (int k = 0; k < NPL_MAX_RECEIVES; k++)
+    {
+        int size = (int)recvfrom(session->socket, (char*)data, sizeof(data), 0, NULL, NULL);
+        if ((size < 0) && (NPL_WouldBlock())) { break; }
+        if (size > 0) { NPL_ReadPacket(session, data, size); }
+    }
+}
+
+void NPL_StepWorld(NPL_Session* session)
+{
+    TRON_World* world = session->world;
+    Uint64 tick = TRON_GetWorldTick(world) + 1;
+    int slot = tick % NPL_WINDOW;
+
+    for (int i = 0; i < session->num_players; i++)
+    {
+        Uint16 input = NPL_GetInput(session, i, tick);
+        session->used[slot][i] = input;
+        if (input & NPL_TURN_FLAG) { TRON_QueueTurn(world, i, (input >> 8) & 3, input & 0xFF); }
+    }
+    TRON_StepWorld(world);
+    TRON_SaveSnapshot(world, session->snapshots[slot]);
+    session->hashes[slot] = TRON_GetWorldHash(world);
+    session->alive[slot] = TRON_CountAliveBikes(world);
+}
+
+bool NPL_Rollback(NPL_Session* session)
+{
+    Uint64 target = session->rollback_tick;
+    session->rollback_tick = 0;
+    if ((target == 0) || (target > session->tick)) { return false; }
+    if (!TRON_RestoreSnapshot(session->world, session->snapshots[(target - 1) % NPL_WINDOW])) { return false; }
+
+    while (TRON_GetWorldTick(session->world) < session->tick) { NPL_StepWorld(session); }
+
+    int depth = (int)(session->tick - target + 1);
+    session->stats.rollbacks++;
+    session->stats.resimulated_ticks += depth;
+    session->stats.max_rollback = SDL_max(session->stats.max_rollback, depth);
+
+    return true;
+}
+
+void NPL_CheckHashes(NPL_Session* session)
+{
+    for (int i = 0; i < session->num_players; i++)
+    {
+        NPL_Peer* peer = &session->peers[i];
+        if ((!peer->active) || (peer->checked) || (peer->check_tick > session->confirmed) || (peer->check_tick + NPL_WINDOW <= session->tick)) { continue; }
+
+        peer->checked = true;
+        if ((session->hashes[peer->check_tick % NPL_WINDOW] != peer->check_hash) && (session->stats.desync_tick < 0))
+        {
+            session->stats.desync_tick = (Sint64)peer->check_tick;
+            SDL_Log("Netplay desync with player %d at tick %" SDL_PRIu64, i + 1, peer->check_tick);
+        }
+    }
+}
+
+bool NPL_ConfirmTicks(NPL_Session* session)
+{
+    Uint64 confirmed = session->tick;
+    for (int i = 0; i < session->num_players; i++)
+    {
+        if (session->peers[i].active) { confirmed = SDL_min(confirmed, session->peers[i].received); }
+    }
+    for (Uint64 tick = session->confirmed + 1; (tick <= confirmed) && (!session->end_tick); tick++)
+    {
+        if (session->alive[tick % NPL_WINDOW] <= 1) { session->end_tick = tick; }
+    }
+    session->confirmed = session->end_tick ? SDL_min(confirmed, session->end_tick) : confirmed;
+    session->stats.confirmed_tick = session->confirmed;
+    NPL_CheckHashes(session);
+
+    if ((!session->end_tick) || (session->tick == session->end_tick)) { return false; }
+
+    TRON_RestoreSnapshot(session->world, session->snapshots[session->end_tick % NPL_WINDOW]);
+    session->tick = session->end_tick;
+    return true;
+}
+
+void NPL_SyncPeers(NPL_Session* session)
+{
+    if (session->tick < session->sync_tick + NPL_SYNC_INTERVAL) { return; }
+
+    int lead = 0;
+    for (int i = 0; i < session->num_players; i++)
+    {
+        const NPL_Peer* peer = &session->peers[i];
+        if (!peer->active) { continue; }
+
+        int advantage = (int)((Sint64)session->tick - (Sint64)peer->remote_tick);
+        lead = SDL_max(lead, (advantage - peer->remote_advantage) / 2);
+    }
+    session->skip = SDL_min(lead, NPL_MAX_SKIP);
+    session->sync_tick = session->tick;
+}
+
+void NPL_AdvanceTicks(NPL_Session* session, Uint64 now)
+{
+    if (now > session->tick_time + NPL_MAX_CATCH_UP_TICKS * NPL_TICK_NS)
+    {
+        session->tick_time = now - NPL_MAX_CATCH_UP_TICKS * NPL_TICK_NS;
+    }
+    NPL_SyncPeers(session);
+
+    while (session->tick_time + NPL_TICK_NS <= now)
+    {
+        session->tick_time += NPL_TICK_NS;
+        if ((session->skip > 0) || (session->tick >= session->confirmed + NPL_MAX_ROLLBACK))
+        {
+            session->skip = SDL_max(session->skip - 1, 0);
+            session->stats.stalled_ticks++;
+            continue;
+        }
+
+        NPL_StepWorld(session);
+        session->tick++;
+    }
+}
+
+bool NPL_HasHeardPeers(NPL_Session* session)
+{
+    for (int i = 0; i < session->num_players; i++)
+    {
+        if ((i != session->local_player) && (!session->peers[i].heard)) { return false; }
+    }
+
+    return true;
+}
+
+bool NPL_UpdateSession(NPL_Session* session, Uint64 now)
+{
+    NPL_ReceivePackets(session);
+
+    bool rewound = false;
+    if (!session->running)
+    {
+        session->running = NPL_HasHeardPeers(session);
+        session->tick_time = now;
+    }
+    else if (!session->end_tick)
+    {
+        rewound = NPL_Rollback(session);
+        rewound = NPL_ConfirmTicks(session) || rewound;
+        if (!session->end_tick) { NPL_AdvanceTicks(session, now); }
+    }
+
+    if (now >= session->send_time + NPL_TICK_NS)
+    {
+        NPL_SendInputs(session, now);
+        session->send_time = now;
+    }
+    NPL_FlushPackets(session, now);
+
+    return rewound;
+}
+
+bool NPL_IsSessionReady(NPL_Session* session)
+{
+    return session->running;
+}
+
+bool NPL_IsRoundOver(NPL_Session* session)
+{
+    if (!session->end_tick) { return false; }
+
+    for (int i = 0; i < session->num_players; i++)
+    {
+        const NPL_Peer* peer = &session->peers[i];
+        if ((peer->active) && (!peer->finished) && (peer->acked < session->end_tick)) { return false; }
+    }
+
+    return true;
+}
+
+Uint64 NPL_GetTickTime(NPL_Session* session)
+{
+    return session->tick_time;
+}
+
+Uint64 NPL_GetConfirmedTick(NPL_Session* session)
+{
+    return session->confirmed;
+}
+
+bool NPL_GetConfirmedTurn(NPL_Session* session, Uint64 tick, int player, TRON_Direction* direction, int* fraction)
+{
+    if ((tick == 0) || (tick > session->confirmed) || (tick + NPL_WINDOW <= session->tick) || (player < 0) || (player >= session->num_players)) { return false; }
+
+    Uint16 input = session->used[tick % NPL_WINDOW][player];
+    if (!(input & NPL_TURN_FLAG)) { return false; }
+
+    *direction = (input >> 8) & 3;
+    *fraction = input & 0xFF;
+    return true;
+}
+
+bool NPL_GetTickHash(NPL_Session* session, Uint64 tick, Uint64* hash)
+{
+    if ((tick > session->tick) || (tick + NPL_WINDOW <= session->tick)) { return false; }
+
+    *hash = session->hashes[tick % NPL_WINDOW];
+    return true;
+}
+
+NPL_Stats NPL_GetSessionStats(NPL_Session* session)
+{
+    return session->stats;
+}
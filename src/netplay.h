@@ -0,0 +1,57 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include "tron.h"
+
+#define NPL_MAX_PLAYERS 4
+
+typedef struct NPL_Session NPL_Session;
+
+typedef struct NPL_Conditions
+{
+    int latency_ms;
+    int jitter_ms;
+    int loss_percent;
+}NPL_Conditions;
+
+typedef struct NPL_Stats
+{
+    Uint64 confirmed_tick;
+    int rollbacks;
+    int max_rollback;
+    int resimulated_ticks;
+    int stalled_ticks;
+    int sent_packets;
+    int dropped_packets;
+    int received_packets;
+    Sint64 desync_tick;
+}NPL_Stats;
+
+NPL_Session* NPL_CreateSession(TRON_World* world, int num_players, int local_player, Uint16 port);
+
+void NPL_DestroySession(NPL_Session* session);
+
+bool NPL_SetPeer(NPL_Session* session, int player, const char* address);
+
+void NPL_SetConditions(NPL_Session* session, NPL_Conditions conditions);
+
+void NPL_SetInputDelay(NPL_Session* session, int ticks);
+
+void NPL_RestartSession(NPL_Session* session);
+
+bool NPL_PushTurn(NPL_Session* session, TRON_Direction direction, Uint64 timestamp);
+
+bool NPL_UpdateSession(NPL_Session* session, Uint64 now);
+
+bool NPL_IsSessionReady(NPL_Session* session);
+
+bool NPL_IsRoundOver(NPL_Session* session);
+
+Uint64 NPL_GetTickTime(NPL_Session* session);
+
+Uint64 NPL_GetConfirmedTick(NPL_Session* session);
+
+bool NPL_GetConfirmedTurn(NPL_Session* session, Uint64 tick, int player, TRON_Direction* direction, int* fraction);
+
+bool NPL_GetTickHash(NPL_Session* session, Uint64 tick, Uint64* hash);
+
+NPL_Stats NPL_GetSessionStats(NPL_Session* session);
@@ -0,0 +1,254 @@
+#include "render.h"
+
+#define RND_MIN_QUAD_CAPACITY 256
+#define RND_MIN_COMMAND_CAPACITY 64
+
+typedef struct RND_Command
+{
+    int layer;
+    int order;
+    SDL_Texture* texture;
+    int first;
+    int count;
+}RND_Command;
+
+struct RND_Queue
+{
+    SDL_Renderer* renderer;
+    SDL_Texture* target;
+    SDL_Texture* texture;
+    bool bound;
+
+    SDL_Vertex* vertices;
+    SDL_Vertex* sorted;
+    int* indices;
+    int num_quads;
+    int quad_capacity;
+
+    RND_Command* commands;
+    int num_commands;
+    int command_capacity;
+
+    RND_Stats stats;
+};
+
+RND_Queue* RND_CreateQueue(SDL_Renderer* renderer)
+{
+    RND_Queue* queue = SDL_calloc(1, sizeof(RND_Queue));
+    queue->renderer = renderer;
+    return queue;
+}
+
+void RND_DestroyQueue(RND_Queue* queue)
+{
+    if (!queue) { return; }
+
+    SDL_free(queue->vertices);
+    SDL_free(queue->sorted);
+    SDL_free(queue->indices);
+    SDL_free(queue->commands);
+    SDL_free(queue);
+}
+
+SDL_Renderer* RND_GetRenderer(RND_Queue* queue)
+{
+    return queue->renderer;
+}
+
+void RND_ReserveQuadCapacity(RND_Queue* queue, int capacity)
+{
+    if (capacity <= queue->quad_capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(queue->quad_capacity * 2, RND_MIN_QUAD_CAPACITY));
+    queue->vertices = SDL_realloc(queue->vertices, capacity * 4 * sizeof(SDL_Vertex));
+    queue->sorted = SDL_realloc(queue->sorted, capacity * 4 * sizeof(SDL_Vertex));
+    queue->indices = SDL_realloc(queue->indices, capacity * 6 * sizeof(int));
+    for (int i = queue->quad_capacity; i < capacity; i++)
+    {
+        int* quad = queue->indices + i * 6;
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4;
+        quad[4] = i * 4 + 2;
+        quad[5] = i * 4 + 3;
+    }
+    queue->quad_capacity = capacity;
+}
+
+void RND_ReserveCommandCapacity(RND_Queue* queue, int capacity)
+{
+    if (capacity <= queue->command_capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(queue->command_capacity * 2, RND_MIN_COMMAND_CAPACITY));
+    queue->commands = SDL_realloc(queue->commands, capacity * sizeof(RND_Command));
+    queue->command_capacity = capacity;
+}
+
+void RND_ReserveQuads(RND_Queue* queue, int count)
+{
+    RND_ReserveQuadCapacity(queue, queue->num_quads + count);
+}
+
+SDL_Vertex* RND_AddQuads(RND_Queue* queue, int layer, SDL_Texture* texture, int count)
+{
+    RND_ReserveQuadCapacity(queue, queue->num_quads + count);
+
+    RND_Command* last = queue->num_commands > 0 ? &queue->commands[queue->num_commands - 1] : NULL;
+    if ((last) && (last->layer == layer) && (last->texture == texture))
+    {
+        last->count += count;
+    }
+    else
+    {
+        RND_ReserveCommandCapacity(queue, queue->num_commands + 1);
+        queue->commands[queue->num_commands] = (RND_Command){layer, queue->num_commands, texture, queue->num_quads, count};
+        queue->num_commands++;
+    }
+
+    SDL_Vertex* vertices = queue->vertices + queue->num_quads * 4;
+    queue->num_quads += count;
+    return vertices;
+}
+
+void RND_AddRect(RND_Queue* queue, int layer, const SDL_FRect* rect, SDL_Color color)
+{
+    SDL_FColor vertex_color = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    SDL_Vertex* quad = RND_AddQuads(queue, layer, NULL, 1);
+    quad[0] = (SDL_Vertex){{rect->x, rect->y}, vertex_color, {0.0f, 0.0f}};
+    quad[1] = (SDL_Vertex){{rect->x + rect->w, rect->y}, vertex_color, {0.0f, 0.0f}};
+    quad[2] = (SDL_Vertex){{rect->x + rect->w, rect->y + rect->h}, vertex_color, {0.0f, 0.0f}};
+    quad[3] = (SDL_Vertex){{rect->x, rect->y + rect->h}, vertex_color, {0.0f, 0.0f}};
+}
+
+void RND_AddRotatedQuad(RND_Queue* queue, int layer, SDL_Texture* texture, const SDL_FRect* rect, const SDL_FRect* uv, SDL_FPoint pivot, float angle, SDL_FColor color)
+{
+    float radians = angle * SDL_PI_F / 180.0f;
+    float cos_angle = SDL_cosf(radians);
+    float sin_angle = SDL_sinf(radians);
+    SDL_FPoint corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+    SDL_Vertex* quad = RND_AddQuads(queue, layer, texture, 1);
+    for (int i = 0; i < 4; i++)
+    {
+        float x = rect->x + corners[i].x * rect->w - pivot.x;
+        float y = rect->y + corners[i].y * rect->h - pivot.y;
+        quad[i].position = (SDL_FPoint){pivot.x + x * cos_angle - y * sin_angle, pivot.y + x * sin_angle + y * cos_angle};
+        quad[i].color = color;
+        quad[i].tex_coord = (SDL_FPoint){uv->x + corners[i].x * uv->w, uv->y + corners[i].y * uv->h};
+    }
+}
+
+int RND_CompareCommands(const void* a, const void* b)
+{
+    const RND_Command* first = a;
+    const RND_Command* second = b;
+
+    if (first->layer != second->layer) { return first->layer < second->layer ? -1 : 1; }
+    if (first->texture != second->texture) { return (uintptr_t)first->texture < (uintptr_t)second->texture ? -1 : 1; }
+    return first->order < second->order ? -1 : (first->order > second->order);
+}
+
+void RND_Draw(RND_Queue* queue, SDL_Texture* texture, int first, int count)
+{
+    if ((!queue->bound) || (texture != queue->texture))
+    {
+        queue->stats.state_changes++;
+        queue->texture = texture;
+        queue->bound = true;
+    }
+
+    SDL_RenderGeometry(queue->renderer, texture, queue->sorted + first * 4, count * 4, queue->indices, count * 6);
+    queue->stats.draw_calls++;
+    queue->stats.primitives += count * 2;
+}
+
+void RND_CopyQuads(RND_Queue* queue, const RND_Command* command, int offset, const RND_View* view)
+{
+    const SDL_Vertex* source = queue->vertices + command->first * 4;
+    SDL_Vertex* destination = queue->sorted + offset * 4;
+
+    if (!view)
+    {
+        SDL_memcpy(destination, source, command->count * 4 * sizeof(SDL_Vertex));
+        return;
+    }
+
+    for (int i = 0; i < command->count * 4; i++)
+    {
+        destination[i] = source[i];
+        destination[i].position.x = source[i].position.x * view->scale + view->offset.x;
+        destination[i].position.y = source[i].position.y * view->scale + view->offset.y;
+    }
+}
+
+void RND_Emit(RND_Queue* queue, const RND_View* view)
+{
+    int first = 0;
+    int num_quads = 0;
+    for (int i = 0; i < queue->num_commands; i++)
+    {
+        RND_Command* command = &queue->commands[i];
+        RND_CopyQuads(queue, command, num_quads, view);
+        num_quads += command->count;
+
+        if ((i + 1 == queue->num_commands) || (queue->commands[i + 1].texture != command->texture))
+        {
+            RND_Draw(queue, command->texture, first, num_quads - first);
+            first = num_quads;
+        }
+    }
+}
+
+void RND_FlushViews(RND_Queue* queue, const RND_View* views, int num_views)
+{
+    if (queue->num_commands == 0) { return; }
+
+    SDL_qsort(queue->commands, queue->num_commands, sizeof(RND_Command), RND_CompareCommands);
+
+    if (!views)
+    {
+        RND_Emit(queue, NULL);
+    }
+    else
+    {
+        for (int i = 0; i < num_views; i++)
+        {
+            SDL_SetRenderClipRect(queue->renderer, &views[i].clip);
+            queue->stats.state_changes++;
+            RND_Emit(queue, &views[i]);
+        }
+        SDL_SetRenderClipRect(queue->renderer, NULL);
+    }
+
+    queue->stats.commands += queue->num_commands;
+    queue->num_commands = 0;
+    queue->num_quads = 0;
+}
+
+void RND_Flush(RND_Queue* queue)
+{
+    RND_FlushViews(queue, NULL, 0);
+}
+
+void RND_SetTarget(RND_Queue* queue, SDL_Texture* target)
+{
+    RND_Flush(queue);
+    if (target == queue->target) { return; }
+
+    SDL_SetRenderTarget(queue->renderer, target);
+    queue->target = target;
+    queue->bound = false;
+    queue->stats.state_changes++;
+}
+
+RND_Stats RND_GetStats(RND_Queue* queue)
+{
+    return queue->stats;
+}
+
+void RND_ResetStats(RND_Queue* queue)
+{
+    queue->stats = (RND_Stats){0};
+    queue->bound = false;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_render.h>
+
+typedef struct RND_Stats
+{
+    int draw_calls;
+    int state_changes;
+    int primitives;
+    int commands;
+}RND_Stats;
+
+typedef struct RND_View
+{
+    SDL_FPoint offset;
+    float scale;
+    SDL_Rect clip;
+}RND_View;
+
+typedef struct RND_Queue RND_Queue;
+
+RND_Queue* RND_CreateQueue(SDL_Renderer* renderer);
+
+void RND_DestroyQueue(RND_Queue* queue);
+
+SDL_Renderer* RND_GetRenderer(RND_Queue* queue);
+
+void RND_ReserveQuads(RND_Queue* queue, int count);
+
+SDL_Vertex* RND_AddQuads(RND_Queue* queue, int layer, SDL_Texture* texture, int count);
+
+void RND_AddRect(RND_Queue* queue, int layer, const SDL_FRect* rect, SDL_Color color);
+
+void RND_AddRotatedQuad(RND_Queue* queue, int layer, SDL_Texture* texture, const SDL_FRect* rect, const SDL_FRect* uv, SDL_FPoint pivot, float angle, SDL_FColor color);
+
+void RND_SetTarget(RND_Queue* queue, SDL_Texture* target);
+
+void RND_Flush(RND_Queue* queue);
+
+void RND_FlushViews(RND_Queue* queue, const RND_View* views, int num_views);
+
+RND_Stats RND_GetStats(RND_Queue* queue);
+
+void RND_ResetStats(RND_Queue* queue);
@@ -0,0 +1,510 @@
+#include "replay.h"
+#include <SDL3/SDL_error.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_properties.h>
+
+#define RPL_MAGIC 0x524E5254u
+#define RPL_VERSION 4
+#define RPL_KEYFRAME_INTERVAL 600
+#define RPL_MIN_CAPACITY 256
+
+typedef struct RPL_Start
+{
+    SDL_FPoint position;
+    TRON_Direction direction;
+    float speed;
+}RPL_Start;
+
+typedef struct RPL_Keyframe
+{
+    Uint64 tick;
+    Uint64 offset;
+    Uint32 size;
+}RPL_Keyframe;
+
+typedef struct RPL_Header
+{
+    SDL_FPoint arena;
+    int num_bikes;
+    RPL_Start* starts;
+    Uint64 length;
+}RPL_Header;
+
+struct RPL_Recorder
+{
+    RPL_Header header;
+
+    Uint8* inputs;
+    int num_input_bytes;
+    int input_capacity;
+    int num_inputs;
+    Uint64 last_input_tick;
+
+    Uint64* hashes;
+    Uint64 num_hashes;
+    Uint64 hash_capacity;
+
+    SDL_IOStream* keyframe_stream;
+    RPL_Keyframe* keyframes;
+    int num_keyframes;
+    int keyframe_capacity;
+};
+
+struct RPL_Player
+{
+    RPL_Header header;
+    TRON_World* world;
+    Uint8* data;
+    size_t size;
+
+    Uint64* input_ticks;
+    int* input_bikes;
+    Uint8* input_directions;
+    Uint8* input_fractions;
+    int num_inputs;
+    int cursor;
+
+    Uint64* hashes;
+    Uint64 num_hashes;
+
+    RPL_Keyframe* keyframes;
+    int num_keyframes;
+};
+
+void RPL_ReserveInputBytes(RPL_Recorder* recorder, int capacity)
+{
+    if (capacity <= recorder->input_capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(recorder->input_capacity * 2, RPL_MIN_CAPACITY));
+    recorder->inputs = SDL_realloc(recorder->inputs, capacity);
+    recorder->input_capacity = capacity;
+}
+
+void RPL_WriteVarint(RPL_Recorder* recorder, Uint64 value)
+{
+    RPL_ReserveInputBytes(recorder, recorder->num_input_bytes + 10);
+    do
+    {
+        Uint8 byte = value & 0x7F;
+        value >>= 7;
+        recorder->inputs[recorder->num_input_bytes++] = byte | (value ? 0x80 : 0);
+    }
+    while (value);
+}
+
+bool RPL_ReadVarint(const Uint8** cursor, const Uint8* end, Uint64* value)
+{
+    *value = 0;
+    for (int shift = 0; (shift < 64) && (*cursor < end); shift += 7)
+    {
+        Uint8 byte = *(*cursor)++;
+        *value |= (Uint64)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) { return true; }
+    }
+
+    return false;
+}
+
+Uint32 RPL_GetFloatBits(float value)
+{
+    Uint32 bits;
+    SDL_memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float RPL_GetBitsFloat(Uint32 bits)
+{
+    float value;
+    SDL_memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void RPL_RecordHash(RPL_Recorder* recorder, TRON_World* world)
+{
+    Uint64 tick = TRON_GetWorldTick(world);
+    if (tick >= recorder->hash_capacity)
+    {
+        recorder->hash_capacity = SDL_max(tick + 1, SDL_max(recorder->hash_capacity * 2, RPL_MIN_CAPACITY));
+        recorder->hashes = SDL_realloc(recorder->hashes, recorder->hash_capacity * sizeof(Uint64));
+    }
+
+    for (Uint64 i = recorder->num_hashes; i < tick; i++)
+    {
+        recorder->hashes[i] = 0;
+    }
+    recorder->hashes[tick] = TRON_GetWorldHash(world);
+    recorder->num_hashes = tick + 1;
+}
+
+RPL_Recorder* RPL_CreateRecorder(TRON_World* world)
+{
+    RPL_Recorder* recorder = SDL_calloc(1, sizeof(RPL_Recorder));
+    recorder->header.arena = TRON_GetWorldSize(world);
+    recorder->header.num_bikes = TRON_GetNumBikes(world);
+    recorder->header.starts = SDL_calloc(recorder->header.num_bikes, sizeof(RPL_Start));
+    for (int i = 0; i < recorder->header.num_bikes; i++)
+    {
+        recorder->header.starts[i] = (RPL_Start){TRON_GetBikePosition(world, i), TRON_GetBikeDirection(world, i), TRON_GetBikeSpeed(world, i)};
+    }
+    recorder->header.length = TRON_GetWorldTick(world);
+    recorder->keyframe_stream = SDL_IOFromDynamicMem();
+    RPL_RecordHash(recorder, world);
+
+    return recorder;
+}
+
+void RPL_DestroyRecorder(RPL_Recorder* recorder)
+{
+    if (!recorder) { return; }
+
+    SDL_CloseIO(recorder->keyframe_stream);
+    SDL_free(recorder->header.starts);
+    SDL_free(recorder->inputs);
+    SDL_free(recorder->hashes);
+    SDL_free(recorder->keyframes);
+    SDL_free(recorder);
+}
+
+void RPL_RecordTurn(RPL_Recorder* recorder, Uint64 tick, int bike, TRON_Direction direction, int fraction)
+{
+    RPL_WriteVarint(recorder, tick - recorder->last_input_tick);
+    RPL_WriteVarint(recorder, ((Uint64)bike << 2) | direction);
+    RPL_ReserveInputBytes(recorder, recorder->num_input_bytes + 1);
+    recorder->inputs[recorder->num_input_bytes++] = (Uint8)fraction;
+    recorder->last_input_tick = tick;
+    recorder->num_inputs++;
+}
+
+void RPL_RecordTick(RPL_Recorder* recorder, TRON_World* world)
+{
+    Uint64 tick = TRON_GetWorldTick(world);
+    recorder->header.length = tick;
+    RPL_RecordHash(recorder, world);
+    if ((tick % RPL_KEYFRAME_INTERVAL != 0) || (!recorder->keyframe_stream)) { return; }
+
+    if (recorder->num_keyframes == recorder->keyframe_capacity)
+    {
+        recorder->keyframe_capacity = SDL_max(recorder->keyframe_capacity * 2, RPL_MIN_CAPACITY);
+        recorder->keyframes = SDL_realloc(recorder->keyframes, recorder->keyframe_capacity * sizeof(RPL_Keyframe));
+    }
+
+    Sint64 offset = SDL_TellIO(recorder->keyframe_stream);
+    TRON_SaveWorld(world, recorder->keyframe_stream);
+    Uint32 size = (Uint32)(SDL_TellIO(recorder->keyframe_stream) - offset);
+    recorder->keyframes[recorder->num_keyframes++] = (RPL_Keyframe){tick, (Uint64)offset, size};
+}
+
+void RPL_WriteHeader(const RPL_Header* header, SDL_IOStream* stream)
+{
+    SDL_WriteU32LE(stream, RPL_MAGIC);
+    SDL_WriteU32LE(stream, RPL_VERSION);
+    SDL_WriteU32LE(stream, RPL_GetFloatBits(header->arena.x));
+    SDL_WriteU32LE(stream, RPL_GetFloatBits(header->arena.y));
+    SDL_WriteU32LE(stream, header->num_bikes);
+    for (int i = 0; i < header->num_bikes; i++)
+    {
+        const RPL_Start* start = &header->starts[i];
+        SDL_WriteU32LE(stream, RPL_GetFloatBits(start->position.x));
+        SDL_WriteU32LE(stream, RPL_GetFloatBits(start->position.y));
+        SDL_WriteU8(stream, start->direction);
+        SDL_WriteU32LE(stream, RPL_GetFloatBits(start->speed));
+    }
+    SDL_WriteU64LE(stream, header->length);
+}
+
+bool RPL_SaveRecording(RPL_Recorder* recorder, const char* path)
+{
+    SDL_IOStream* stream = SDL_IOFromFile(path, "wb");
+    if (!stream) { return false; }
+
+    RPL_WriteHeader(&recorder->header, stream);
+    SDL_WriteU32LE(stream, recorder->num_inputs);
+    SDL_WriteU32LE(stream, recorder->num_input_bytes);
+    SDL_WriteIO(stream, recorder->inputs, recorder->num_input_bytes);
+
+    SDL_WriteU64LE(stream, recorder->num_hashes);
+    for (Uint64 i = 0; i < recorder->num_hashes; i++)
+    {
+        SDL_WriteU64LE(stream, recorder->hashes[i]);
+    }
+
+    SDL_WriteU32LE(stream, recorder->num_keyframes);
+    for (int i = 0; i < recorder->num_keyframes; i++)
+    {
+        SDL_WriteU64LE(stream, recorder->keyframes[i].tick);
+        SDL_WriteU32LE(stream, recorder->keyframes[i].size);
+    }
+
+    const Uint8* keyframes = SDL_GetPointerProperty(SDL_GetIOProperties(recorder->keyframe_stream), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    if (keyframes) { SDL_WriteIO(stream, keyframes, (size_t)SDL_TellIO(recorder->keyframe_stream)); }
+
+    return SDL_CloseIO(stream);
+}
+
+bool RPL_ReadHeader(RPL_Header* header, SDL_IOStream* stream)
+{
+    Uint32 magic = 0;
+    Uint32 version = 0;
+    Uint32 width = 0;
+    Uint32 height = 0;
+    Uint32 num_bikes = 0;
+    if ((!SDL_ReadU32LE(stream, &magic)) || (!SDL_ReadU32LE(stream, &version)) || (magic != RPL_MAGIC) || (version != RPL_VERSION))
+    {
+        return SDL_SetError("Not a light bike replay");
+    }
+    if ((!SDL_ReadU32LE(stream, &width)) || (!SDL_ReadU32LE(stream, &height)) || (!SDL_ReadU32LE(stream, &num_bikes)) || (num_bikes < 1) || (num_bikes > TRON_MAX_WORLD_BIKES))
+    {
+        return SDL_SetError("Corrupt replay header");
+    }
+
+    header->arena = (SDL_FPoint){RPL_GetBitsFloat(width), RPL_GetBitsFloat(height)};
+    header->num_bikes = num_bikes;
+    header->starts = SDL_calloc(num_bikes, sizeof(RPL_Start));
+    for (Uint32 i = 0; i < num_bikes; i++)
+    {
+        Uint32 x = 0;
+        Uint32 y = 0;
+        Uint8 direction = 0;
+        Uint32 speed = 0;
+        if ((!SDL_ReadU32LE(stream, &x)) || (!SDL_ReadU32LE(stream, &y)) || (!SDL_ReadU8(stream, &direction)) || (!SDL_ReadU32LE(stream, &speed)))
+        {
+            return SDL_SetError("Corrupt replay header");
+        }
+        header->starts[i] = (RPL_Start){{RPL_GetBitsFloat(x), RPL_GetBitsFloat(y)}, direction % 4, RPL_GetBitsFloat(speed)};
+    }
+
+    return SDL_ReadU64LE(stream, &header->length);
+}
+
+bool RPL_ReadInputs(RPL_Player* player, SDL_IOStream* stream)
+{
+    Uint32 num_inputs = 0;
+    Uint32 num_bytes = 0;
+    if ((!SDL_ReadU32LE(stream, &num_inputs)) || (!SDL_ReadU32LE(stream, &num_bytes))) { return false; }
+
+    Sint64 offset = SDL_TellIO(stream);
+    if ((offset < 0) || ((Uint64)offset + num_bytes > player->size) || (num_inputs > num_bytes)) { return SDL_SetError("Corrupt replay inputs"); }
+
+    player->input_ticks = SDL_malloc(num_inputs * sizeof(Uint64));
+    player->input_bikes = SDL_malloc(num_inputs * sizeof(int));
+    player->input_directions = SDL_malloc(num_inputs * sizeof(Uint8));
+    player->input_fractions = SDL_malloc(num_inputs * sizeof(Uint8));
+
+    const Uint8* cursor = player->data + offset;
+    const Uint8* end = cursor + num_bytes;
+    Uint64 tick = 0;
+    for (Uint32 i = 0; i < num_inputs; i++)
+    {
+        Uint64 delta = 0;
+        Uint64 bike = 0;
+        if ((!RPL_ReadVarint(&cursor, end, &delta)) || (!RPL_ReadVarint(&cursor, end, &bike)) || (cursor >= end))
+        {
+            return SDL_SetError("Corrupt replay inputs");
+        }
+
+        tick += delta;
+        player->input_ticks[i] = tick;
+        player->input_bikes[i] = (int)SDL_min(bike >> 2, TRON_MAX_WORLD_BIKES);
+        player->input_directions[i] = bike & 3;
+        player->input_fractions[i] = *cursor++;
+    }
+    player->num_inputs = num_inputs;
+
+    return SDL_SeekIO(stream, num_bytes, SDL_IO_SEEK_CUR) >= 0;
+}
+
+bool RPL_ReadHashes(RPL_Player* player, SDL_IOStream* stream)
+{
+    Uint64 num_hashes = 0;
+    if (!SDL_ReadU64LE(stream, &num_hashes)) { return false; }
+    Sint64 offset = SDL_TellIO(stream);
+    if ((offset < 0) || (num_hashes > ((Uint64)player->size - (Uint64)offset) / sizeof(Uint64)) || (num_hashes > player->header.length + 1)) { return SDL_SetError("Corrupt replay hashes"); }
+
+    player->hashes = SDL_malloc(SDL_max(num_hashes, 1) * sizeof(Uint64));
+    for (Uint64 i = 0; i < num_hashes; i++)
+    {
+        if (!SDL_ReadU64LE(stream, &player->hashes[i])) { return false; }
+    }
+    player->num_hashes = num_hashes;
+
+    return true;
+}
+
+bool RPL_ReadKeyframes(RPL_Player* player, SDL_IOStream* stream)
+{
+    Uint32 num_keyframes = 0;
+    if (!SDL_ReadU32LE(stream, &num_keyframes)) { return false; }
+    if ((Uint64)num_keyframes * 12 > player->size) { return SDL_SetError("Corrupt replay keyframes"); }
+
+    player->keyframes = SDL_calloc(SDL_max(num_keyframes, 1), sizeof(RPL_Keyframe));
+    for (Uint32 i = 0; i < num_keyframes; i++)
+    {
+        RPL_Keyframe* keyframe = &player->keyframes[i];
+        if ((!SDL_ReadU64LE(stream, &keyframe->tick)) || (!SDL_ReadU32LE(stream, &keyframe->size))) { return false; }
+    }
+
+    Uint64 offset = (Uint64)SDL_TellIO(stream);
+    for (Uint32 i = 0; i < num_keyframes; i++)
+    {
+        player->keyframes[i].offset = offset;
+        offset += player->keyframes[i].size;
+    }
+    if (offset > player->size) { return SDL_SetError("Corrupt replay keyframes"); }
+    player->num_keyframes = num_keyframes;
+
+    return true;
+}
+
+void RPL_RestartReplay(RPL_Player* player)
+{
+    TRON_ResetWorld(player->world, player->header.num_bikes);
+    for (int i = 0; i < player->header.num_bikes; i++)
+    {
+        const RPL_Start* start = &player->header.starts[i];
+        TRON_SetBikeStart(player->world, i, start->position, start->direction);
+        TRON_SetBikeSpeed(player->world, i, start->speed);
+    }
+    player->cursor = 0;
+}
+
+RPL_Player* RPL_OpenReplay(const char* path)
+{
+    RPL_Player* player = SDL_calloc(1, sizeof(RPL_Player));
+    player->data = SDL_LoadFile(path, &player->size);
+    SDL_IOStream* stream = player->data ? SDL_IOFromConstMem(player->data, player->size) : NULL;
+
+    bool ok = (stream) && (RPL_ReadHeader(&player->header, stream)) && (RPL_ReadInputs(player, stream)) && (RPL_ReadHashes(player, stream)) && (RPL_ReadKeyframes(player, stream));
+    SDL_CloseIO(stream);
+    if (!ok)
+    {
+        RPL_CloseReplay(player);
+        return NULL;
+    }
+
+    player->world = TRON_CreateWorld(player->header.arena.x, player->header.arena.y, player->header.num_bikes);
+    RPL_RestartReplay(player);
+
+    return player;
+}
+
+void RPL_CloseReplay(RPL_Player* player)
+{
+    if (!player) { return; }
+
+    TRON_DestroyWorld(player->world);
+    SDL_free(player->header.starts);
+    SDL_free(player->data);
+    SDL_free(player->input_ticks);
+    SDL_free(player->input_bikes);
+    SDL_free(player->input_directions);
+    SDL_free(player->input_fractions);
+    SDL_free(player->hashes);
+    SDL_free(player->keyframes);
+    SDL_free(player);
+}
+
+TRON_World* RPL_GetReplayWorld(RPL_Player* player)
+{
+    return player->world;
+}
+
+int RPL_GetReplayBikes(RPL_Player* player)
+{
+    return player->header.num_bikes;
+}
+
+Uint64 RPL_GetReplayLength(RPL_Player* player)
+{
+    return player->header.length;
+}
+
+bool RPL_GetReplayHash(RPL_Player* player, Uint64 tick, Uint64* hash)
+{
+    if (tick >= player->num_hashes) { return false; }
+
+    *hash = player->hashes[tick];
+    return true;
+}
+
+Sint64 RPL_FindDivergence(RPL_Player* first, RPL_Player* second)
+{
+    Uint64 count = SDL_min(first->num_hashes, second->num_hashes);
+    for (Uint64 i = 0; i < count; i++)
+    {
+        if (first->hashes[i] != second->hashes[i]) { return (Sint64)i; }
+    }
+
+    return first->num_hashes == second->num_hashes ? -1 : (Sint64)count;
+}
+
+bool RPL_StepReplay(RPL_Player* player)
+{
+    Uint64 tick = TRON_GetWorldTick(player->world) + 1;
+    if (tick > player->header.length) { return false; }
+
+    while ((player->cursor < player->num_inputs) && (player->input_ticks[player->cursor] <= tick))
+    {
+        int i = player->cursor++;
+        if (player->input_ticks[i] < tick) { continue; }
+        TRON_QueueTurn(player->world, player->input_bikes[i], player->input_directions[i], player->input_fractions[i]);
+    }
+    TRON_StepWorld(player->world);
+
+    return true;
+}
+
+bool RPL_LoadKeyframe(RPL_Player* player, const RPL_Keyframe* keyframe)
+{
+    SDL_IOStream* stream = SDL_IOFromConstMem(player->data + keyframe->offset, keyframe->size);
+    bool ok = (stream) && (TRON_LoadWorld(player->world, stream));
+    SDL_CloseIO(stream);
+    if (!ok) { return SDL_SetError("Corrupt replay keyframe"); }
+
+    int low = 0;
+    int high = player->num_inputs;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (player->input_ticks[middle] <= keyframe->tick) { low = middle + 1; }
+        else { high = middle; }
+    }
+    player->cursor = low;
+
+    return true;
+}
+
+bool RPL_SeekReplay(RPL_Player* player, Uint64 tick)
+{
+    tick = SDL_min(tick, player->header.length);
+    Uint64 current = TRON_GetWorldTick(player->world);
+
+    int low = 0;
+    int high = player->num_keyframes;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (player->keyframes[middle].tick <= tick) { low = middle + 1; }
+        else { high = middle; }
+    }
+
+    const RPL_Keyframe* keyframe = low > 0 ? &player->keyframes[low - 1] : NULL;
+    Uint64 start = keyframe ? keyframe->tick : 0;
+    if ((current > tick) || (current < start))
+    {
+        if (keyframe)
+        {
+            if (!RPL_LoadKeyframe(player, keyframe)) { return false; }
+        }
+        else
+        {
+            RPL_RestartReplay(player);
+        }
+    }
+
+    while (TRON_GetWorldTick(player->world) < tick)
+    {
+        if (!RPL_StepReplay(player)) { break; }
+    }
+
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include "tron.h"
+
+typedef struct RPL_Recorder RPL_Recorder;
+
+typedef struct RPL_Player RPL_Player;
+
+RPL_Recorder* RPL_CreateRecorder(TRON_World* world);
+
+void RPL_DestroyRecorder(RPL_Recorder* recorder);
+
+void RPL_RecordTurn(RPL_Recorder* recorder, Uint64 tick, int bike, TRON_Direction direction, int fraction);
+
+void RPL_RecordTick(RPL_Recorder* recorder, TRON_World* world);
+
+bool RPL_SaveRecording(RPL_Recorder* recorder, const char* path);
+
+RPL_Player* RPL_OpenReplay(const char* path);
+
+void RPL_CloseReplay(RPL_Player* player);
+
+TRON_World* RPL_GetReplayWorld(RPL_Player* player);
+
+int RPL_GetReplayBikes(RPL_Player* player);
+
+Uint64 RPL_GetReplayLength(RPL_Player* player);
+
+bool RPL_GetReplayHash(RPL_Player* player, Uint64 tick, Uint64* hash);
+
+Sint64 RPL_FindDivergence(RPL_Player* first, RPL_Player* second);
+
+bool RPL_StepReplay(RPL_Player* player);
+
+bool RPL_SeekReplay(RPL_Player* player, Uint64 tick);
@@ -0,0 +1,220 @@
+#include "simulation.h"
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+
+#define SIM_TICK_NS (SDL_NS_PER_SECOND / TRON_TICK_RATE)
+#define SIM_MAX_CATCH_UP_TICKS 8
+#define SIM_INPUT_CAPACITY 256
+#define SIM_NUM_STATES 3
+#define SIM_STATE_INDEX 3
+#define SIM_FRESH_STATE 4
+
+typedef struct SIM_Input
+{
+    int bike;
+    TRON_Direction direction;
+    Uint64 timestamp;
+}SIM_Input;
+
+typedef struct SIM_State
+{
+    TRON_World* world;
+    Uint64 tick_time;
+}SIM_State;
+
+struct SIM_Simulation
+{
+    TRON_World* world;
+    LAT_Probe* probe;
+    RPL_Recorder* recorder;
+    SDL_Thread* thread;
+    SDL_AtomicInt running;
+    Uint64 tick_time;
+
+    SIM_Input inputs[SIM_INPUT_CAPACITY];
+    SDL_AtomicU32 input_head;
+    SDL_AtomicU32 input_tail;
+    SIM_Input pending[SIM_INPUT_CAPACITY];
+    int num_pending;
+
+    SIM_State states[SIM_NUM_STATES];
+    SDL_AtomicInt ready;
+    int back;
+    int front;
+};
+
+SIM_Simulation* SIM_CreateSimulation(TRON_World* world, LAT_Probe* probe)
+{
+    SIM_Simulation* simulation = SDL_calloc(1, sizeof(SIM_Simulation));
+    simulation->world = world;
+    simulation->probe = probe;
+    for (int i = 0; i < SIM_NUM_STATES; i++)
+    {
+        simulation->states[i].world = TRON_CreateWorldMirror();
+        TRON_MirrorWorld(simulation->states[i].world, world);
+    }
+    simulation->front = 0;
+    SDL_SetAtomicInt(&simulation->ready, 1);
+    simulation->back = 2;
+
+    return simulation;
+}
+
+void SIM_DestroySimulation(SIM_Simulation* simulation)
+{
+    if (!simulation) { return; }
+
+    SIM_StopSimulation(simulation);
+    for (int i = 0; i < SIM_NUM_STATES; i++)
+    {
+        TRON_DestroyWorld(simulation->states[i].world);
+    }
+    SDL_free(simulation);
+}
+
+void SIM_ReadInputs(SIM_Simulation* simulation)
+{
+    Uint32 tail = SDL_GetAtomicU32(&simulation->input_tail);
+    Uint32 head = SDL_GetAtomicU32(&simulation->input_head);
+
+    while ((tail != head) && (simulation->num_pending < SIM_INPUT_CAPACITY))
+    {
+        simulation->pending[simulation->num_pending++] = simulation->inputs[tail % SIM_INPUT_CAPACITY];
+        tail++;
+    }
+    SDL_SetAtomicU32(&simulation->input_tail, tail);
+}
+
+void SIM_QueueTurns(SIM_Simulation* simulation)
+{
+    Uint64 tick_time = simulation->tick_time;
+    Uint64 next_tick = TRON_GetWorldTick(simulation->world) + 1;
+
+    int count = 0;
+    for (int i = 0; i < simulation->num_pending; i++)
+    {
+        SIM_Input* input = &simulation->pending[i];
+        if (input->timestamp >= tick_time + SIM_TICK_NS)
+        {
+            simulation->pending[count++] = *input;
+            continue;
+        }
+
+        int fraction = input->timestamp > tick_time ? (int)((input->timestamp - tick_time) * TRON_TURN_FRACTION_STEPS / SIM_TICK_NS) : 0;
+        TRON_QueueTurn(simulation->world, input->bike, input->direction, fraction);
+        if (simulation->recorder) { RPL_RecordTurn(simulation->recorder, next_tick, input->bike, input->direction, fraction); }
+        if (simulation->probe) { LAT_AddInput(simulation->probe, input->timestamp, next_tick, input->bike); }
+    }
+    simulation->num_pending = count;
+}
+
+void SIM_PublishState(SIM_Simulation* simulation)
+{
+    SIM_State* state = &simulation->states[simulation->back];
+    TRON_MirrorWorld(state->world, simulation->world);
+    state->tick_time = simulation->tick_time;
+
+    int previous = SDL_SetAtomicInt(&simulation->ready, simulation->back | SIM_FRESH_STATE);
+    simulation->back = previous & SIM_STATE_INDEX;
+}
+
+void SIM_Advance(SIM_Simulation* simulation)
+{
+    SIM_ReadInputs(simulation);
+
+    Uint64 now = SDL_GetTicksNS();
+    if (now > simulation->tick_time + SIM_MAX_CATCH_UP_TICKS * SIM_TICK_NS)
+    {
+        simulation->tick_time = now - SIM_MAX_CATCH_UP_TICKS * SIM_TICK_NS;
+    }
+
+    while ((SDL_GetAtomicInt(&simulation->running)) && (simulation->tick_time + SIM_TICK_NS <= now))
+    {
+        SIM_QueueTurns(simulation);
+        TRON_StepWorld(simulation->world);
+        simulation->tick_time += SIM_TICK_NS;
+        if (simulation->recorder) { RPL_RecordTick(simulation->recorder, simulation->world); }
+        if (simulation->probe) { LAT_ResolveInputs(simulation->probe, simulation->world, SDL_GetTicksNS()); }
+        SIM_PublishState(simulation);
+
+        if (TRON_CountAliveBikes(simulation->world) <= 1) { SDL_SetAtomicInt(&simulation->running, 0); }
+    }
+}
+
+int SIM_ThreadMain(void* data)
+{
+    SIM_Simulation* simulation = data;
+
+    while (SDL_GetAtomicInt(&simulation->running))
+    {
+        SIM_Advance(simulation);
+
+        Uint64 now = SDL_GetTicksNS();
+        Uint64 next = simulation->tick_time + SIM_TICK_NS;
+        if (next > now) { SDL_DelayPrecise(next - now); }
+    }
+
+    return 0;
+}
+
+void SIM_StartSimulation(SIM_Simulation* simulation, Uint64 start_time)
+{
+    SIM_StopSimulation(simulation);
+
+    simulation->tick_time = start_time;
+    simulation->num_pending = 0;
+    SDL_SetAtomicU32(&simulation->input_tail, SDL_GetAtomicU32(&simulation->input_head));
+    SIM_PublishState(simulation);
+    SDL_SetAtomicInt(&simulation->running, 1);
+
+    simulation->thread = SDL_CreateThread(SIM_ThreadMain, "TRON simulation", simulation);
+}
+
+void SIM_StopSimulation(SIM_Simulation* simulation)
+{
+    SDL_SetAtomicInt(&simulation->running, 0);
+    if (!simulation->thread) { return; }
+
+    SDL_WaitThread(simulation->thread, NULL);
+    simulation->thread = NULL;
+}
+
+void SIM_SetRecorder(SIM_Simulation* simulation, RPL_Recorder* recorder)
+{
+    SIM_StopSimulation(simulation);
+    simulation->recorder = recorder;
+}
+
+bool SIM_IsSimulationRunning(SIM_Simulation* simulation)
+{
+    return SDL_GetAtomicInt(&simulation->running);
+}
+
+void SIM_UpdateSimulation(SIM_Simulation* simulation)
+{
+    if ((!simulation->thread) && (SDL_GetAtomicInt(&simulation->running))) { SIM_Advance(simulation); }
+}
+
+bool SIM_PushTurn(SIM_Simulation* simulation, int bike, TRON_Direction direction, Uint64 timestamp)
+{
+    Uint32 head = SDL_GetAtomicU32(&simulation->input_head);
+    if (head - SDL_GetAtomicU32(&simulation->input_tail) == SIM_INPUT_CAPACITY) { return false; }
+
+    simulation->inputs[head % SIM_INPUT_CAPACITY] = (SIM_Input){bike, direction, timestamp};
+    SDL_SetAtomicU32(&simulation->input_head, head + 1);
+    return true;
+}
+
+TRON_World* SIM_AcquireState(SIM_Simulation* simulation, Uint64* tick_time)
+{
+    if (SDL_GetAtomicInt(&simulation->ready) & SIM_FRESH_STATE)
+    {
+        int previous = SDL_SetAtomicInt(&simulation->ready, simulation->front);
+        simulation->front = previous & SIM_STATE_INDEX;
+    }
+
+    SIM_State* state = &simulation->states[simulation->front];
+    if (tick_time) { *tick_time = state->tick_time; }
+    return state->world;
+}
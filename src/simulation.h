@@ -0,0 +1,25 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include "latency.h"
+#include "replay.h"
+#include "tron.h"
+
+typedef struct SIM_Simulation SIM_Simulation;
+
+SIM_Simulation* SIM_CreateSimulation(TRON_World* world, LAT_Probe* probe);
+
+void SIM_DestroySimulation(SIM_Simulation* simulation);
+
+void SIM_StartSimulation(SIM_Simulation* simulation, Uint64 start_time);
+
+void SIM_StopSimulation(SIM_Simulation* simulation);
+
+void SIM_SetRecorder(SIM_Simulation* simulation, RPL_Recorder* recorder);
+
+bool SIM_IsSimulationRunning(SIM_Simulation* simulation);
+
+void SIM_UpdateSimulation(SIM_Simulation* simulation);
+
+bool SIM_PushTurn(SIM_Simulation* simulation, int bike, TRON_Direction direction, Uint64 timestamp);
+
+TRON_World* SIM_AcquireState(SIM_Simulation* simulation, Uint64* tick_time);
@@ -0,0 +1,103 @@
+#include "text.h"
+
+#define TXT_FIRST_GLYPH ' '
+#define TXT_LAST_GLYPH '~'
+#define TXT_MISSING_GLYPH '?'
+#define TXT_ATLAS_COLUMNS 16
+#define TXT_ATLAS_ROWS 6
+#define TXT_GLYPH_SIZE SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE
+
+struct TXT_Atlas
+{
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+};
+
+bool TXT_DrawGlyphs(TXT_Atlas* atlas)
+{
+    SDL_Texture* target = SDL_GetRenderTarget(atlas->renderer);
+    if (!SDL_SetRenderTarget(atlas->renderer, atlas->texture)) { return false; }
+
+    SDL_SetRenderDrawColor(atlas->renderer, 0, 0, 0, 0);
+    SDL_RenderClear(atlas->renderer);
+    SDL_SetRenderDrawColor(atlas->renderer, 255, 255, 255, 255);
+    for (int row = 0; row < TXT_ATLAS_ROWS; row++)
+    {
+        char line[TXT_ATLAS_COLUMNS + 1] = {0};
+        for (int column = 0; column < TXT_ATLAS_COLUMNS; column++)
+        {
+            int glyph = TXT_FIRST_GLYPH + row * TXT_ATLAS_COLUMNS + column;
+            line[column] = (glyph <= TXT_LAST_GLYPH) ? (char)glyph : ' ';
+        }
+        SDL_RenderDebugText(atlas->renderer, 0.0f, (float)(row * TXT_GLYPH_SIZE), line);
+    }
+
+    SDL_SetRenderTarget(atlas->renderer, target);
+    return true;
+}
+
+bool TXT_CreateAtlasTexture(TXT_Atlas* atlas)
+{
+    atlas->texture = SDL_CreateTexture(atlas->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, TXT_ATLAS_COLUMNS * TXT_GLYPH_SIZE, TXT_ATLAS_ROWS * TXT_GLYPH_SIZE);
+    if (!atlas->texture) { return false; }
+
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(atlas->texture, SDL_SCALEMODE_NEAREST);
+    return TXT_DrawGlyphs(atlas);
+}
+
+TXT_Atlas* TXT_CreateAtlas(SDL_Renderer* renderer)
+{
+    TXT_Atlas* atlas = SDL_calloc(1, sizeof(TXT_Atlas));
+    atlas->renderer = renderer;
+    if (!TXT_CreateAtlasTexture(atlas))
+    {
+        TXT_DestroyAtlas(atlas);
+        return NULL;
+    }
+
+    return atlas;
+}
+
+void TXT_DestroyAtlas(TXT_Atlas* atlas)
+{
+    if (!atlas) { return; }
+
+    SDL_DestroyTexture(atlas->texture);
+    SDL_free(atlas);
+}
+
+bool TXT_RestoreAtlas(TXT_Atlas* atlas)
+{
+    SDL_DestroyTexture(atlas->texture);
+    atlas->texture = NULL;
+    return TXT_CreateAtlasTexture(atlas);
+}
+
+SDL_FPoint TXT_GetTextSize(const char* text)
+{
+    return (SDL_FPoint){(float)(SDL_strlen(text) * TXT_GLYPH_SIZE), (float)TXT_GLYPH_SIZE};
+}
+
+void TXT_AddText(TXT_Atlas* atlas, RND_Queue* queue, int layer, const char* text, SDL_FPoint center, SDL_FPoint scale, float angle, SDL_Color color)
+{
+    int length = (int)SDL_strlen(text);
+    RND_ReserveQuads(queue, length);
+
+    float width = (float)(TXT_ATLAS_COLUMNS * TXT_GLYPH_SIZE);
+    float height = (float)(TXT_ATLAS_ROWS * TXT_GLYPH_SIZE);
+    SDL_FColor vertex_color = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    SDL_FPoint size = {TXT_GLYPH_SIZE * scale.x, TXT_GLYPH_SIZE * scale.y};
+    SDL_FPoint origin = {center.x - length * size.x / 2.0f, center.y - size.y / 2.0f};
+
+    for (int i = 0; i < length; i++)
+    {
+        int glyph = (unsigned char)text[i];
+        if ((glyph < TXT_FIRST_GLYPH) || (glyph > TXT_LAST_GLYPH)) { glyph = TXT_MISSING_GLYPH; }
+        glyph -= TXT_FIRST_GLYPH;
+
+        SDL_FRect rect = {origin.x + i * size.x, origin.y, size.x, size.y};
+        SDL_FRect uv = {(glyph % TXT_ATLAS_COLUMNS) * TXT_GLYPH_SIZE / width, (glyph / TXT_ATLAS_COLUMNS) * TXT_GLYPH_SIZE / height, TXT_GLYPH_SIZE / width, TXT_GLYPH_SIZE / height};
+        RND_AddRotatedQuad(queue, layer, atlas->texture, &rect, &uv, center, angle, vertex_color);
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_render.h>
+#include "render.h"
+
+typedef struct TXT_Atlas TXT_Atlas;
+
+TXT_Atlas* TXT_CreateAtlas(SDL_Renderer* renderer);
+
+void TXT_DestroyAtlas(TXT_Atlas* atlas);
+
+bool TXT_RestoreAtlas(TXT_Atlas* atlas);
+
+SDL_FPoint TXT_GetTextSize(const char* text);
+
+void TXT_AddText(TXT_Atlas* atlas, RND_Queue* queue, int layer, const char* text, SDL_FPoint center, SDL_FPoint scale, float angle, SDL_Color color);
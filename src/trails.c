@@ -0,0 +1,202 @@
+#include "trails.h"
+
+#define TRL_BUCKET_SIZE 256.0f
+#define TRL_MIN_CAPACITY 1024
+
+struct TRL_Index
+{
+    int columns;
+    int rows;
+    int* buckets;
+
+    int* entry_segments;
+    int* entry_nexts;
+    int num_entries;
+    int entry_capacity;
+
+    int* heads;
+    SDL_Rect* covered;
+    int num_bikes;
+    int bike_capacity;
+
+    Uint32* marks;
+    int* results;
+    int num_segments;
+    int segment_capacity;
+    Uint32 query;
+};
+
+SDL_FRect TRL_GetSegmentRect(SDL_FPoint start, SDL_FPoint end)
+{
+    float x1 = SDL_min(start.x, end.x) - TRON_TRAIL_SIZE / 2;
+    float y1 = SDL_min(start.y, end.y) - TRON_TRAIL_SIZE / 2;
+    float x2 = SDL_max(start.x, end.x) + TRON_TRAIL_SIZE / 2;
+    float y2 = SDL_max(start.y, end.y) + TRON_TRAIL_SIZE / 2;
+    return (SDL_FRect){x1, y1, x2 - x1, y2 - y1};
+}
+
+TRL_Index* TRL_CreateIndex(float width, float height)
+{
+    TRL_Index* index = SDL_calloc(1, sizeof(TRL_Index));
+    index->columns = SDL_max((int)SDL_ceilf(width / TRL_BUCKET_SIZE), 1);
+    index->rows = SDL_max((int)SDL_ceilf(height / TRL_BUCKET_SIZE), 1);
+    index->buckets = SDL_malloc(index->columns * index->rows * sizeof(int));
+    TRL_ClearIndex(index);
+
+    return index;
+}
+
+void TRL_DestroyIndex(TRL_Index* index)
+{
+    if (!index) { return; }
+
+    SDL_free(index->buckets);
+    SDL_free(index->entry_segments);
+    SDL_free(index->entry_nexts);
+    SDL_free(index->heads);
+    SDL_free(index->covered);
+    SDL_free(index->marks);
+    SDL_free(index->results);
+    SDL_free(index);
+}
+
+void TRL_ClearIndex(TRL_Index* index)
+{
+    SDL_memset(index->buckets, 0xFF, index->columns * index->rows * sizeof(int));
+    if (index->heads) { SDL_memset(index->heads, 0xFF, index->bike_capacity * sizeof(int)); }
+    index->num_entries = 0;
+    index->num_segments = 0;
+    index->num_bikes = 0;
+}
+
+void TRL_ReserveEntries(TRL_Index* index, int capacity)
+{
+    if (capacity <= index->entry_capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(index->entry_capacity * 2, TRL_MIN_CAPACITY));
+    index->entry_segments = SDL_realloc(index->entry_segments, capacity * sizeof(int));
+    index->entry_nexts = SDL_realloc(index->entry_nexts, capacity * sizeof(int));
+    index->entry_capacity = capacity;
+}
+
+void TRL_ReserveSegments(TRL_Index* index, int capacity)
+{
+    if (capacity <= index->segment_capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(index->segment_capacity * 2, TRL_MIN_CAPACITY));
+    index->marks = SDL_realloc(index->marks, capacity * sizeof(Uint32));
+    index->results = SDL_realloc(index->results, capacity * sizeof(int));
+    SDL_memset(index->marks + index->segment_capacity, 0, (capacity - index->segment_capacity) * sizeof(Uint32));
+    index->segment_capacity = capacity;
+}
+
+void TRL_ReserveBikes(TRL_Index* index, int capacity)
+{
+    if (capacity <= index->bike_capacity) { return; }
+
+    index->heads = SDL_realloc(index->heads, capacity * sizeof(int));
+    index->covered = SDL_realloc(index->covered, capacity * sizeof(SDL_Rect));
+    SDL_memset(index->heads + index->bike_capacity, 0xFF, (capacity - index->bike_capacity) * sizeof(int));
+    index->bike_capacity = capacity;
+}
+
+SDL_Rect TRL_GetBucketRange(TRL_Index* index, const SDL_FRect* rect)
+{
+    int x1 = SDL_clamp((int)SDL_floorf(rect->x / TRL_BUCKET_SIZE), 0, index->columns - 1);
+    int y1 = SDL_clamp((int)SDL_floorf(rect->y / TRL_BUCKET_SIZE), 0, index->rows - 1);
+    int x2 = SDL_clamp((int)SDL_floorf((rect->x + rect->w) / TRL_BUCKET_SIZE), 0, index->columns - 1);
+    int y2 = SDL_clamp((int)SDL_floorf((rect->y + rect->h) / TRL_BUCKET_SIZE), 0, index->rows - 1);
+    return (SDL_Rect){x1, y1, x2 - x1 + 1, y2 - y1 + 1};
+}
+
+void TRL_InsertSegment(TRL_Index* index, int segment, const SDL_FRect* rect, SDL_Rect* covered)
+{
+    SDL_Rect range = TRL_GetBucketRange(index, rect);
+
+    for (int y = range.y; y < range.y + range.h; y++)
+    {
+        for (int x = range.x; x < range.x + range.w; x++)
+        {
+            if ((x >= covered->x) && (x < covered->x + covered->w) && (y >= covered->y) && (y < covered->y + covered->h)) { continue; }
+
+            int bucket = y * index->columns + x;
+            TRL_ReserveEntries(index, index->num_entries + 1);
+            index->entry_segments[index->num_entries] = segment;
+            index->entry_nexts[index->num_entries] = index->buckets[bucket];
+            index->buckets[bucket] = index->num_entries;
+            index->num_entries++;
+        }
+    }
+
+    *covered = range;
+}
+
+void TRL_UpdateIndex(TRL_Index* index, TRON_World* world)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+    int num_bikes = TRON_GetNumBikes(world);
+    if ((segments.count < index->num_segments) || (num_bikes != index->num_bikes))
+    {
+        TRL_ClearIndex(index);
+        index->num_bikes = num_bikes;
+    }
+    TRL_ReserveBikes(index, num_bikes);
+    TRL_ReserveSegments(index, segments.count);
+
+    for (int i = 0; i < num_bikes; i++)
+    {
+        int head = index->heads[i];
+        if (head < 0) { continue; }
+
+        SDL_FRect rect = TRL_GetSegmentRect(TRON_GetFloatPoint(segments.starts[head]), TRON_GetFloatPoint(segments.ends[head]));
+        TRL_InsertSegment(index, head, &rect, &index->covered[i]);
+        if ((head != TRON_GetBikeHeadSegment(world, i)) || (TRON_IsBikeDead(world, i))) { index->heads[i] = -1; }
+    }
+
+    for (int i = index->num_segments; i < segments.count; i++)
+    {
+        int owner = segments.owners[i];
+        SDL_Rect covered = {0, 0, 0, 0};
+        SDL_FRect rect = TRL_GetSegmentRect(TRON_GetFloatPoint(segments.starts[i]), TRON_GetFloatPoint(segments.ends[i]));
+        TRL_InsertSegment(index, i, &rect, &covered);
+        if ((i == TRON_GetBikeHeadSegment(world, owner)) && (!TRON_IsBikeDead(world, owner)))
+        {
+            index->heads[owner] = i;
+            index->covered[owner] = covered;
+        }
+    }
+    index->num_segments = segments.count;
+}
+
+int TRL_QueryIndex(TRL_Index* index, const SDL_FRect* areas, int num_areas, const int** segments)
+{
+    index->query++;
+    if (index->query == 0)
+    {
+        SDL_memset(index->marks, 0, index->segment_capacity * sizeof(Uint32));
+        index->query = 1;
+    }
+
+    int count = 0;
+    for (int i = 0; i < num_areas; i++)
+    {
+        SDL_Rect range = TRL_GetBucketRange(index, &areas[i]);
+        for (int y = range.y; y < range.y + range.h; y++)
+        {
+            for (int x = range.x; x < range.x + range.w; x++)
+            {
+                for (int entry = index->buckets[y * index->columns + x]; entry >= 0; entry = index->entry_nexts[entry])
+                {
+                    int segment = index->entry_segments[entry];
+                    if (index->marks[segment] == index->query) { continue; }
+
+                    index->marks[segment] = index->query;
+                    index->results[count++] = segment;
+                }
+            }
+        }
+    }
+
+    *segments = index->results;
+    return count;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_rect.h>
+#include "tron.h"
+
+typedef struct TRL_Index TRL_Index;
+
+TRL_Index* TRL_CreateIndex(float width, float height);
+
+void TRL_DestroyIndex(TRL_Index* index);
+
+void TRL_ClearIndex(TRL_Index* index);
+
+void TRL_UpdateIndex(TRL_Index* index, TRON_World* world);
+
+int TRL_QueryIndex(TRL_Index* index, const SDL_FRect* areas, int num_areas, const int** segments);
+
+SDL_FRect TRL_GetSegmentRect(SDL_FPoint start, SDL_FPoint end);
@@ -0,0 +1,2220 @@
+#include "tron.h"
+#include "boxes.h"
+#include "jobs.h"
+#include <SDL3/SDL_bits.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_iostream.h>
+
+#define TRON_RAY_LINES 8
+#define TRON_MIN_EVENT_CAPACITY 256
+#define TRON_MIN_PAIR_CAPACITY 256
+#define TRON_MIN_TURN_CAPACITY 64
+#define TRON_MIN_STAMP_CAPACITY 1024
+#define TRON_MIN_PARALLEL_BIKES 256
+#define TRON_MAX_WORKERS 15
+#define TRON_MAX_SPAWN_WIDTH (1920 * TRON_FIXED_ONE)
+#define TRON_MAX_SPAWN_HEIGHT (1080 * TRON_FIXED_ONE)
+#define TRON_SPAWN_MARGIN (100 * TRON_FIXED_ONE)
+#define TRON_FIXED_TRAIL_SIZE ((Sint32)(TRON_TRAIL_SIZE * TRON_FIXED_ONE))
+#define TRON_HALF_TRAIL_SIZE (TRON_FIXED_TRAIL_SIZE / 2)
+#define TRON_FIXED_BIKE_WIDTH (TRON_BIKE_WIDTH * TRON_FIXED_ONE)
+#define TRON_FIXED_BIKE_HEIGHT (TRON_BIKE_HEIGHT * TRON_FIXED_ONE)
+#define TRON_FIXED_BIKE_SPEED ((Sint32)(TRON_BIKE_SPEED * TRON_FIXED_ONE))
+#define TRON_TIME_ONE 65536
+
+typedef struct TRON_Stamp
+{
+    int cell;
+    int previous_segment;
+}TRON_Stamp;
+
+typedef struct TRON_Grid
+{
+    int width;
+    int height;
+    Uint64* occupied;
+    int* segments;
+    int* column_rays;
+    int* row_rays;
+    TRON_Stamp* stamps;
+    int num_stamps;
+    int stamp_capacity;
+}TRON_Grid;
+
+typedef struct TRON_Trails
+{
+    SDL_Point* starts;
+    SDL_Point* ends;
+    Uint16* owners;
+    int* nexts;
+    int count;
+    int capacity;
+}TRON_Trails;
+
+typedef struct TRON_Events
+{
+    Uint64* ticks;
+    int* bikes;
+    int count;
+    int capacity;
+}TRON_Events;
+
+typedef struct TRON_Turns
+{
+    int* bikes;
+    Uint8* directions;
+    int* fractions;
+    int count;
+    int capacity;
+}TRON_Turns;
+
+typedef struct TRON_Pairs
+{
+    int* first;
+    int* second;
+    int count;
+    int capacity;
+}TRON_Pairs;
+
+typedef struct TRON_Sweep
+{
+    SDL_Rect rect;
+    SDL_Rect hull;
+    Sint32 front;
+    Sint32 length;
+    Sint32 back;
+    int sign;
+}TRON_Sweep;
+
+typedef struct TRON_Collision
+{
+    Sint32 time;
+    SDL_Point point;
+    int other;
+}TRON_Collision;
+
+struct TRON_World
+{
+    Sint32 width;
+    Sint32 height;
+    int num_bikes;
+    int num_alive;
+    int capacity;
+
+    Sint32* x;
+    Sint32* y;
+    Sint32* speed;
+    Uint8* direction;
+    bool* dead;
+    int* moved;
+
+    SDL_Point* previous_positions;
+    SDL_Point* checked_positions;
+    SDL_Rect* checked_rects;
+    int* checked_segments;
+    int* head_segments;
+    int* previous_segments;
+    Sint64* last_turn_ticks;
+    Uint64* death_ticks;
+    TRON_Sweep* sweeps;
+    TRON_Collision* impacts;
+    bool* dying;
+
+    Uint64* predicted_ticks;
+    bool* due;
+    bool* ray_vertical;
+    Uint8* ray_counts;
+    int* ray_ends;
+    int* ray_lines;
+    int* ray_nexts;
+    int* ray_prevs;
+
+    int* sap_order;
+    int sap_count;
+    int* neighbor_offsets;
+    int* neighbor_cursors;
+    int* neighbors;
+    int neighbor_capacity;
+
+    TRON_Grid grid;
+    TRON_Trails trails;
+    TRON_Events events;
+    TRON_Turns turns;
+    BOX_Boxes hulls;
+    BOX_Boxes fresh_trails;
+    TRON_Pairs pairs;
+    JOB_Pool* pool;
+    int num_threads;
+    Uint64 tick;
+    Uint64 checked_tick;
+    Uint64 generation;
+    Uint64 round;
+    Uint64 hash;
+    Uint64* bike_hashes;
+};
+
+struct TRON_Snapshot
+{
+    TRON_World bikes;
+    SDL_Point* head_starts;
+    SDL_Point* head_ends;
+    int num_segments;
+    int num_stamps;
+    Uint64 round;
+};
+
+
+static const int TRON_DIRECTION_X[4] = {0, 1, 0, -1};
+static const int TRON_DIRECTION_Y[4] = {-1, 0, 1, 0};
+
+Sint32 TRON_ToFixed(float value)
+{
+    return (Sint32)SDL_roundf(value * TRON_FIXED_ONE);
+}
+
+SDL_Point TRON_ToFixedPoint(SDL_FPoint point)
+{
+    return (SDL_Point){TRON_ToFixed(point.x), TRON_ToFixed(point.y)};
+}
+
+SDL_FPoint TRON_GetFloatPoint(SDL_Point point)
+{
+    return (SDL_FPoint){point.x / (float)TRON_FIXED_ONE, point.y / (float)TRON_FIXED_ONE};
+}
+
+Sint32 TRON_GetTime(Sint64 part, Sint64 whole)
+{
+    return whole > 0 ? (Sint32)(part * TRON_TIME_ONE / whole) : 0;
+}
+
+void TRON_InitGrid(TRON_Grid* grid, int width, int height)
+{
+    grid->width = width;
+    grid->height = height;
+    grid->occupied = SDL_calloc((width * height + 63) / 64, sizeof(Uint64));
+    grid->segments = SDL_calloc(width * height, sizeof(int));
+    grid->column_rays = SDL_malloc(width * sizeof(int));
+    grid->row_rays = SDL_malloc(height * sizeof(int));
+    SDL_memset(grid->column_rays, 0xFF, width * sizeof(int));
+    SDL_memset(grid->row_rays, 0xFF, height * sizeof(int));
+}
+
+void TRON_ClearGrid(TRON_Grid* grid)
+{
+    SDL_memset(grid->occupied, 0, ((grid->width * grid->height + 63) / 64) * sizeof(Uint64));
+    SDL_memset(grid->column_rays, 0xFF, grid->width * sizeof(int));
+    SDL_memset(grid->row_rays, 0xFF, grid->height * sizeof(int));
+    grid->num_stamps = 0;
+}
+
+void TRON_QuitGrid(TRON_Grid* grid)
+{
+    SDL_free(grid->occupied);
+    SDL_free(grid->segments);
+    SDL_free(grid->column_rays);
+    SDL_free(grid->row_rays);
+    SDL_free(grid->stamps);
+}
+
+int TRON_GetGridCell(Sint32 coordinate)
+{
+    if (coordinate >= 0) { return coordinate / TRON_FIXED_TRAIL_SIZE; }
+    return -((TRON_FIXED_TRAIL_SIZE - 1 - coordinate) / TRON_FIXED_TRAIL_SIZE);
+}
+
+bool TRON_IsCellOccupied(TRON_Grid* grid, int x, int y)
+{
+    int index = y * grid->width + x;
+    return (grid->occupied[index >> 6] >> (index & 63)) & 1;
+}
+
+bool TRON_StampCell(TRON_Grid* grid, int x, int y, int segment, const TRON_Trails* trails, const bool* dead)
+{
+    if ((x < 0) || (y < 0) || (x >= grid->width) || (y >= grid->height)) { return false; }
+
+    int index = y * grid->width + x;
+    bool occupied = TRON_IsCellOccupied(grid, x, y);
+    if ((occupied) && (!dead[trails->owners[grid->segments[index]]])) { return false; }
+
+    if (grid->num_stamps == grid->stamp_capacity)
+    {
+        grid->stamp_capacity = SDL_max(grid->stamp_capacity * 2, TRON_MIN_STAMP_CAPACITY);
+        grid->stamps = SDL_realloc(grid->stamps, grid->stamp_capacity * sizeof(TRON_Stamp));
+    }
+
+    grid->occupied[index >> 6] |= (Uint64)1 << (index & 63);
+    grid->stamps[grid->num_stamps++] = (TRON_Stamp){index, occupied ? grid->segments[index] : -1};
+    grid->segments[index] = segment;
+
+    return true;
+}
+
+void TRON_UndoStamps(TRON_Grid* grid, int count)
+{
+    for (int k = grid->num_stamps - 1; k >= count; k--)
+    {
+        const TRON_Stamp* stamp = &grid->stamps[k];
+        if (stamp->previous_segment >= 0) { grid->segments[stamp->cell] = stamp->previous_segment; }
+        else { grid->occupied[stamp->cell >> 6] &= ~((Uint64)1 << (stamp->cell & 63)); }
+    }
+    grid->num_stamps = count;
+}
+
+void TRON_ReserveTrails(TRON_Trails* trails, int capacity)
+{
+    if (capacity <= trails->capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(trails->capacity * 2, TRON_MIN_TRAIL_CAPACITY));
+    trails->starts = SDL_realloc(trails->starts, capacity * sizeof(SDL_Point));
+    trails->ends = SDL_realloc(trails->ends, capacity * sizeof(SDL_Point));
+    trails->owners = SDL_realloc(trails->owners, capacity * sizeof(Uint16));
+    trails->nexts = SDL_realloc(trails->nexts, capacity * sizeof(int));
+    trails->capacity = capacity;
+}
+
+void TRON_QuitTrails(TRON_Trails* trails)
+{
+    SDL_free(trails->starts);
+    SDL_free(trails->ends);
+    SDL_free(trails->owners);
+    SDL_free(trails->nexts);
+}
+
+void TRON_ReserveEvents(TRON_Events* events, int capacity)
+{
+    if (capacity <= events->capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(events->capacity * 2, TRON_MIN_EVENT_CAPACITY));
+    events->ticks = SDL_realloc(events->ticks, capacity * sizeof(Uint64));
+    events->bikes = SDL_realloc(events->bikes, capacity * sizeof(int));
+    events->capacity = capacity;
+}
+
+void TRON_QuitEvents(TRON_Events* events)
+{
+    SDL_free(events->ticks);
+    SDL_free(events->bikes);
+}
+
+void TRON_PushEvent(TRON_Events* events, Uint64 tick, int bike)
+{
+    TRON_ReserveEvents(events, events->count + 1);
+
+    int i = events->count++;
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (events->ticks[parent] <= tick) { break; }
+
+        events->ticks[i] = events->ticks[parent];
+        events->bikes[i] = events->bikes[parent];
+        i = parent;
+    }
+    events->ticks[i] = tick;
+    events->bikes[i] = bike;
+}
+
+int TRON_PopEvent(TRON_Events* events)
+{
+    int bike = events->bikes[0];
+    int count = --events->count;
+    Uint64 tick = events->ticks[count];
+    int last = events->bikes[count];
+
+    int i = 0;
+    while (2 * i + 1 < count)
+    {
+        int child = 2 * i + 1;
+        if ((child + 1 < count) && (events->ticks[child + 1] < events->ticks[child])) { child++; }
+        if (tick <= events->ticks[child]) { break; }
+
+        events->ticks[i] = events->ticks[child];
+        events->bikes[i] = events->bikes[child];
+        i = child;
+    }
+    events->ticks[i] = tick;
+    events->bikes[i] = last;
+
+    return bike;
+}
+
+void TRON_ReserveTurns(TRON_Turns* turns, int capacity)
+{
+    if (capacity <= turns->capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(turns->capacity * 2, TRON_MIN_TURN_CAPACITY));
+    turns->bikes = SDL_realloc(turns->bikes, capacity * sizeof(int));
+    turns->directions = SDL_realloc(turns->directions, capacity * sizeof(Uint8));
+    turns->fractions = SDL_realloc(turns->fractions, capacity * sizeof(int));
+    turns->capacity = capacity;
+}
+
+void TRON_QuitTurns(TRON_Turns* turns)
+{
+    SDL_free(turns->bikes);
+    SDL_free(turns->directions);
+    SDL_free(turns->fractions);
+}
+
+void TRON_ReservePairs(TRON_Pairs* pairs, int capacity)
+{
+    if (capacity <= pairs->capacity) { return; }
+
+    capacity = SDL_max(capacity, SDL_max(pairs->capacity * 2, TRON_MIN_PAIR_CAPACITY));
+    pairs->first = SDL_realloc(pairs->first, capacity * sizeof(int));
+    pairs->second = SDL_realloc(pairs->second, capacity * sizeof(int));
+    pairs->capacity = capacity;
+}
+
+void TRON_QuitPairs(TRON_Pairs* pairs)
+{
+    SDL_free(pairs->first);
+    SDL_free(pairs->second);
+}
+
+void TRON_AddPair(TRON_Pairs* pairs, int first, int second)
+{
+    TRON_ReservePairs(pairs, pairs->count + 1);
+    pairs->first[pairs->count] = first;
+    pairs->second[pairs->count] = second;
+    pairs->count++;
+}
+
+Uint64 TRON_MixHash(Uint64 hash, Uint64 value)
+{
+    hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+Uint64 TRON_GetPointBits(SDL_Point point)
+{
+    return (Uint64)(Uint32)point.x | ((Uint64)(Uint32)point.y << 32);
+}
+
+Uint64 TRON_HashBike(TRON_World* world, int index)
+{
+    Uint64 hash = TRON_MixHash(index, TRON_GetPointBits((SDL_Point){world->x[index], world->y[index]}));
+    return TRON_MixHash(hash, (Uint64)(Uint32)world->speed[index] | ((Uint64)world->direction[index] << 32) | ((Uint64)world->dead[index] << 40));
+}
+
+Uint64 TRON_HashSegment(const TRON_Trails* trails, int segment)
+{
+    Uint64 hash = TRON_MixHash(((Uint64)1 << 63) | ((Uint64)trails->owners[segment] << 32) | (Uint32)segment, TRON_GetPointBits(trails->starts[segment]));
+    return TRON_MixHash(hash, TRON_GetPointBits(trails->ends[segment]));
+}
+
+void TRON_UpdateBikeHash(TRON_World* world, int index)
+{
+    Uint64 hash = TRON_HashBike(world, index);
+    world->hash ^= world->bike_hashes[index] ^ hash;
+    world->bike_hashes[index] = hash;
+}
+
+void TRON_SetSegmentEnd(TRON_World* world, int segment, SDL_Point point)
+{
+    world->hash ^= TRON_HashSegment(&world->trails, segment);
+    world->trails.ends[segment] = point;
+    world->hash ^= TRON_HashSegment(&world->trails, segment);
+}
+
+void TRON_RehashWorld(TRON_World* world)
+{
+    world->hash = 0;
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        world->bike_hashes[i] = TRON_HashBike(world, i);
+        world->hash ^= world->bike_hashes[i];
+    }
+    for (int i = 0; i < world->trails.count; i++)
+    {
+        world->hash ^= TRON_HashSegment(&world->trails, i);
+    }
+}
+
+int TRON_AppendSegment(TRON_World* world, int owner, SDL_Point point)
+{
+    TRON_Trails* trails = &world->trails;
+    TRON_ReserveTrails(trails, trails->count + 1);
+
+    int segment = trails->count++;
+    trails->starts[segment] = point;
+    trails->ends[segment] = point;
+    trails->owners[segment] = owner;
+    trails->nexts[segment] = -1;
+    world->hash ^= TRON_HashSegment(trails, segment);
+
+    return segment;
+}
+
+SDL_FRect TRON_GetBikeRectAt(TRON_Direction direction, SDL_FPoint position)
+{
+    if ((direction == TRON_NORTH) || (direction == TRON_SOUTH))
+    {
+        return (SDL_FRect){position.x - TRON_BIKE_WIDTH / 2, position.y - TRON_BIKE_HEIGHT / 2, TRON_BIKE_WIDTH, TRON_BIKE_HEIGHT};
+    }
+    else
+    {
+        return (SDL_FRect){position.x - TRON_BIKE_HEIGHT / 2, position.y - TRON_BIKE_WIDTH / 2, TRON_BIKE_HEIGHT, TRON_BIKE_WIDTH};
+    }
+}
+
+SDL_FRect TRON_GetBikeRect(TRON_World* world, int bike)
+{
+    return TRON_GetBikeRectAt(world->direction[bike], TRON_GetFloatPoint((SDL_Point){world->x[bike], world->y[bike]}));
+}
+
+SDL_Rect TRON_GetBikeBoundsAt(int direction, SDL_Point position)
+{
+    if (direction % 2 == 0)
+    {
+        return (SDL_Rect){position.x - TRON_FIXED_BIKE_WIDTH / 2, position.y - TRON_FIXED_BIKE_HEIGHT / 2, TRON_FIXED_BIKE_WIDTH, TRON_FIXED_BIKE_HEIGHT};
+    }
+    else
+    {
+        return (SDL_Rect){position.x - TRON_FIXED_BIKE_HEIGHT / 2, position.y - TRON_FIXED_BIKE_WIDTH / 2, TRON_FIXED_BIKE_HEIGHT, TRON_FIXED_BIKE_WIDTH};
+    }
+}
+
+SDL_Rect TRON_GetBikeBounds(TRON_World* world, int bike)
+{
+    return TRON_GetBikeBoundsAt(world->direction[bike], (SDL_Point){world->x[bike], world->y[bike]});
+}
+
+int TRON_GetDirectionSign(int direction)
+{
+    return (direction == TRON_NORTH) || (direction == TRON_WEST) ? -1 : 1;
+}
+
+Sint32 TRON_GetRectFront(const SDL_Rect* rect, int direction)
+{
+    switch (direction)
+    {
+        case TRON_NORTH: return rect->y;
+        case TRON_EAST: return rect->x + rect->w;
+        case TRON_SOUTH: return rect->y + rect->h;
+        default: return rect->x;
+    }
+}
+
+void TRON_AllocateBikes(TRON_World* world, int capacity)
+{
+    world->capacity = capacity;
+    world->x = SDL_calloc(capacity, sizeof(Sint32));
+    world->y = SDL_calloc(capacity, sizeof(Sint32));
+    world->speed = SDL_calloc(capacity, sizeof(Sint32));
+    world->direction = SDL_calloc(capacity, sizeof(Uint8));
+    world->dead = SDL_calloc(capacity, sizeof(bool));
+    world->moved = SDL_calloc(capacity, sizeof(int));
+    world->previous_positions = SDL_calloc(capacity, sizeof(SDL_Point));
+    world->checked_positions = SDL_calloc(capacity, sizeof(SDL_Point));
+    world->checked_rects = SDL_calloc(capacity, sizeof(SDL_Rect));
+    world->checked_segments = SDL_calloc(capacity, sizeof(int));
+    world->head_segments = SDL_calloc(capacity, sizeof(int));
+    world->previous_segments = SDL_calloc(capacity, sizeof(int));
+    world->last_turn_ticks = SDL_calloc(capacity, sizeof(Sint64));
+    world->death_ticks = SDL_calloc(capacity, sizeof(Uint64));
+    world->sweeps = SDL_calloc(capacity, sizeof(TRON_Sweep));
+    world->impacts = SDL_calloc(capacity, sizeof(TRON_Collision));
+    world->dying = SDL_calloc(capacity, sizeof(bool));
+    world->predicted_ticks = SDL_calloc(capacity, sizeof(Uint64));
+    world->due = SDL_calloc(capacity, sizeof(bool));
+    world->ray_vertical = SDL_calloc(capacity, sizeof(bool));
+    world->ray_counts = SDL_calloc(capacity, sizeof(Uint8));
+    world->ray_ends = SDL_calloc(capacity, sizeof(int));
+    world->ray_lines = SDL_calloc(capacity * TRON_RAY_LINES, sizeof(int));
+    world->ray_nexts = SDL_calloc(capacity * TRON_RAY_LINES, sizeof(int));
+    world->ray_prevs = SDL_calloc(capacity * TRON_RAY_LINES, sizeof(int));
+    world->sap_order = SDL_calloc(capacity, sizeof(int));
+    world->neighbor_offsets = SDL_calloc(capacity + 1, sizeof(int));
+    world->neighbor_cursors = SDL_calloc(capacity, sizeof(int));
+    world->bike_hashes = SDL_calloc(capacity, sizeof(Uint64));
+}
+
+void TRON_FreeBikes(TRON_World* world)
+{
+    SDL_free(world->x);
+    SDL_free(world->y);
+    SDL_free(world->speed);
+    SDL_free(world->direction);
+    SDL_free(world->dead);
+    SDL_free(world->moved);
+    SDL_free(world->previous_positions);
+    SDL_free(world->checked_positions);
+    SDL_free(world->checked_rects);
+    SDL_free(world->checked_segments);
+    SDL_free(world->head_segments);
+    SDL_free(world->previous_segments);
+    SDL_free(world->last_turn_ticks);
+    SDL_free(world->death_ticks);
+    SDL_free(world->sweeps);
+    SDL_free(world->impacts);
+    SDL_free(world->dying);
+    SDL_free(world->predicted_ticks);
+    SDL_free(world->due);
+    SDL_free(world->ray_vertical);
+    SDL_free(world->ray_counts);
+    SDL_free(world->ray_ends);
+    SDL_free(world->ray_lines);
+    SDL_free(world->ray_nexts);
+    SDL_free(world->ray_prevs);
+    SDL_free(world->sap_order);
+    SDL_free(world->neighbor_offsets);
+    SDL_free(world->neighbor_cursors);
+    SDL_free(world->bike_hashes);
+}
+
+int TRON_GetSpawnColumns(TRON_World* world)
+{
+    Sint64 area = ((Sint64)world->num_bikes * world->width + world->height - 1) / SDL_max(world->height, 1);
+    Sint64 low = 1;
+    Sint64 high = SDL_max(area, 1);
+    while (low < high)
+    {
+        Sint64 middle = (low + high) / 2;
+        if (middle * middle >= area) { high = middle; }
+        else { low = middle + 1; }
+    }
+
+    return (int)low;
+}
+
+void TRON_GetSpawn(TRON_World* world, int index, int columns, SDL_Point* position, TRON_Direction* direction)
+{
+    if (world->num_bikes <= 4)
+    {
+        Sint32 width = SDL_min(world->width, TRON_MAX_SPAWN_WIDTH);
+        Sint32 height = SDL_min(world->height, TRON_MAX_SPAWN_HEIGHT);
+        Sint32 x = (world->width - width) / 2;
+        Sint32 y = (world->height - height) / 2;
+        SDL_Point positions[4] = {{x + TRON_SPAWN_MARGIN, y + TRON_SPAWN_MARGIN}, {x + width - TRON_SPAWN_MARGIN, y + TRON_SPAWN_MARGIN}, {x + TRON_SPAWN_MARGIN, y + height - TRON_SPAWN_MARGIN}, {x + width - TRON_SPAWN_MARGIN, y + height - TRON_SPAWN_MARGIN}};
+        TRON_Direction directions[4] = {TRON_SOUTH, TRON_SOUTH, TRON_NORTH, TRON_NORTH};
+        *position = positions[index];
+        *direction = directions[index];
+        return;
+    }
+
+    int rows = (world->num_bikes + columns - 1) / columns;
+    int column = index % columns;
+    int row = index / columns;
+    position->x = (Sint32)((2 * column + 1) * (Sint64)world->width / (2 * columns));
+    position->y = (Sint32)((2 * row + 1) * (Sint64)world->height / (2 * rows));
+    *direction = (column % 2 == 0) ? TRON_NORTH : TRON_SOUTH;
+}
+
+void TRON_PlaceBike(TRON_World* world, int index, SDL_Point position, TRON_Direction direction)
+{
+    world->x[index] = position.x;
+    world->y[index] = position.y;
+    world->direction[index] = direction;
+    world->previous_positions[index] = position;
+    world->checked_positions[index] = position;
+    world->checked_rects[index] = TRON_GetBikeBoundsAt(direction, position);
+    world->checked_segments[index] = world->head_segments[index];
+    world->hash ^= TRON_HashSegment(&world->trails, world->head_segments[index]);
+    world->trails.starts[world->head_segments[index]] = position;
+    world->trails.ends[world->head_segments[index]] = position;
+    world->hash ^= TRON_HashSegment(&world->trails, world->head_segments[index]);
+    TRON_UpdateBikeHash(world, index);
+}
+
+void TRON_CompactEvents(TRON_World* world)
+{
+    world->events.count = 0;
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        if ((!world->dead[i]) && (world->predicted_ticks[i] != SDL_MAX_UINT64))
+        {
+            TRON_PushEvent(&world->events, world->predicted_ticks[i], i);
+        }
+    }
+}
+
+void TRON_ScheduleBike(TRON_World* world, int index, Uint64 tick)
+{
+    if (tick >= world->predicted_ticks[index]) { return; }
+
+    world->predicted_ticks[index] = tick;
+    if (world->events.count >= world->num_bikes * 4 + TRON_MIN_EVENT_CAPACITY)
+    {
+        TRON_CompactEvents(world);
+        return;
+    }
+    TRON_PushEvent(&world->events, tick, index);
+}
+
+Uint64 TRON_PredictTick(TRON_World* world, int index, Sint32 distance)
+{
+    Sint32 speed = world->speed[index];
+
+    if (distance <= 0) { return world->checked_tick + 1; }
+    if (speed <= 0) { return SDL_MAX_UINT64; }
+
+    Uint64 ticks = (Uint64)(distance / speed);
+    return world->checked_tick + SDL_max(ticks, 2) - 1;
+}
+
+void TRON_LinkRay(TRON_World* world, int index, bool vertical, int first, int last)
+{
+    int* heads = vertical ? world->grid.column_rays : world->grid.row_rays;
+    world->ray_vertical[index] = vertical;
+    world->ray_counts[index] = 0;
+
+    for (int line = first; (line <= last) && (world->ray_counts[index] < TRON_RAY_LINES); line++)
+    {
+        int node = index * TRON_RAY_LINES + world->ray_counts[index]++;
+        world->ray_lines[node] = line;
+        world->ray_prevs[node] = -1;
+        world->ray_nexts[node] = heads[line];
+        if (heads[line] >= 0) { world->ray_prevs[heads[line]] = node; }
+        heads[line] = node;
+    }
+}
+
+void TRON_UnlinkRay(TRON_World* world, int index)
+{
+    int* heads = world->ray_vertical[index] ? world->grid.column_rays : world->grid.row_rays;
+
+    for (int k = 0; k < world->ray_counts[index]; k++)
+    {
+        int node = index * TRON_RAY_LINES + k;
+        int prev = world->ray_prevs[node];
+        int next = world->ray_nexts[node];
+        if (prev >= 0) { world->ray_nexts[prev] = next; }
+        else { heads[world->ray_lines[node]] = next; }
+        if (next >= 0) { world->ray_prevs[next] = prev; }
+    }
+    world->ray_counts[index] = 0;
+}
+
+void TRON_ShortenRay(TRON_World* world, int index, int cell, int owner)
+{
+    if (index == owner) { return; }
+
+    int direction = world->direction[index];
+    int sign = TRON_GetDirectionSign(direction);
+    Sint32 front = TRON_GetRectFront(&world->checked_rects[index], direction);
+    if (((cell - TRON_GetGridCell(front - sign * TRON_HALF_TRAIL_SIZE)) * sign < 0) || ((cell - world->ray_ends[index]) * sign > 0)) { return; }
+
+    Sint32 edge = (sign > 0 ? cell : cell + 1) * TRON_FIXED_TRAIL_SIZE;
+    TRON_ScheduleBike(world, index, TRON_PredictTick(world, index, (edge - front) * sign - TRON_HALF_TRAIL_SIZE));
+}
+
+void TRON_NotifyStamp(TRON_World* world, int x, int y, int owner)
+{
+    for (int node = world->grid.column_rays[x]; node >= 0; node = world->ray_nexts[node])
+    {
+        TRON_ShortenRay(world, node / TRON_RAY_LINES, y, owner);
+    }
+    for (int node = world->grid.row_rays[y]; node >= 0; node = world->ray_nexts[node])
+    {
+        TRON_ShortenRay(world, node / TRON_RAY_LINES, x, owner);
+    }
+}
+
+void TRON_StampTrail(TRON_World* world, SDL_Point from, SDL_Point to, int segment)
+{
+    int owner = world->trails.owners[segment];
+    int x1 = TRON_GetGridCell(from.x);
+    int y1 = TRON_GetGridCell(from.y);
+    int x2 = TRON_GetGridCell(to.x);
+    int y2 = TRON_GetGridCell(to.y);
+
+    for (int y = SDL_min(y1, y2); y <= SDL_max(y1, y2); y++)
+    {
+        for (int x = SDL_min(x1, x2); x <= SDL_max(x1, x2); x++)
+        {
+            if (TRON_StampCell(&world->grid, x, y, segment, &world->trails, world->dead))
+            {
+                TRON_NotifyStamp(world, x, y, owner);
+            }
+        }
+    }
+}
+
+void TRON_SpawnBikes(TRON_World* world, int num_bikes)
+{
+    if (num_bikes > world->capacity)
+    {
+        TRON_FreeBikes(world);
+        TRON_AllocateBikes(world, num_bikes);
+    }
+
+    world->num_bikes = num_bikes;
+    world->num_alive = num_bikes;
+    world->generation++;
+    world->round++;
+    world->trails.count = 0;
+    world->events.count = 0;
+    world->turns.count = 0;
+    world->checked_tick = 0;
+    TRON_ReserveTrails(&world->trails, num_bikes);
+    BOX_ReserveBoxes(&world->hulls, num_bikes);
+    BOX_ReserveBoxes(&world->fresh_trails, 2 * num_bikes);
+    world->fresh_trails.count = 2 * num_bikes;
+    world->sap_count = num_bikes;
+
+    int columns = TRON_GetSpawnColumns(world);
+    for (int i = 0; i < num_bikes; i++)
+    {
+        SDL_Point position;
+        TRON_Direction direction;
+        TRON_GetSpawn(world, i, columns, &position, &direction);
+
+        world->head_segments[i] = TRON_AppendSegment(world, i, position);
+        world->previous_segments[i] = -1;
+        TRON_PlaceBike(world, i, position, direction);
+        world->speed[i] = TRON_FIXED_BIKE_SPEED;
+        world->dead[i] = false;
+        world->moved[i] = 0;
+        world->dying[i] = false;
+        world->last_turn_ticks[i] = -TRON_TURN_COOLDOWN_TICKS;
+        world->death_ticks[i] = 0;
+        world->impacts[i] = (TRON_Collision){0, position, -1};
+        world->sap_order[i] = i;
+        world->due[i] = false;
+        world->ray_counts[i] = 0;
+        world->predicted_ticks[i] = SDL_MAX_UINT64;
+        TRON_ScheduleBike(world, i, 1);
+    }
+    TRON_RehashWorld(world);
+}
+
+TRON_World* TRON_CreateWorld(float width, float height, int num_bikes)
+{
+    TRON_World* world = SDL_calloc(1, sizeof(TRON_World));
+    world->width = TRON_ToFixed(width);
+    world->height = TRON_ToFixed(height);
+    TRON_InitGrid(&world->grid, TRON_GetGridCell(world->width + TRON_FIXED_TRAIL_SIZE - 1), TRON_GetGridCell(world->height + TRON_FIXED_TRAIL_SIZE - 1));
+    num_bikes = SDL_clamp(num_bikes, 1, TRON_MAX_WORLD_BIKES);
+    TRON_AllocateBikes(world, num_bikes);
+    TRON_SpawnBikes(world, num_bikes);
+
+    return world;
+}
+
+void TRON_DestroyWorld(TRON_World* world)
+{
+    if (!world) { return; }
+    TRON_FreeBikes(world);
+    TRON_QuitGrid(&world->grid);
+    TRON_QuitTrails(&world->trails);
+    TRON_QuitEvents(&world->events);
+    TRON_QuitTurns(&world->turns);
+    BOX_QuitBoxes(&world->hulls);
+    BOX_QuitBoxes(&world->fresh_trails);
+    TRON_QuitPairs(&world->pairs);
+    SDL_free(world->neighbors);
+    JOB_DestroyPool(world->pool);
+    SDL_free(world);
+}
+
+TRON_World* TRON_CreateWorldMirror(void)
+{
+    return SDL_calloc(1, sizeof(TRON_World));
+}
+
+void TRON_MirrorWorld(TRON_World* mirror, TRON_World* world)
+{
+    if (mirror->capacity < world->num_bikes)
+    {
+        TRON_FreeBikes(mirror);
+        TRON_AllocateBikes(mirror, world->capacity);
+    }
+
+    TRON_Trails* trails = &mirror->trails;
+    int first = trails->count;
+    if ((mirror->generation != world->generation) || (trails->count > world->trails.count))
+    {
+        first = 0;
+    }
+    else
+    {
+        for (int i = 0; i < mirror->num_bikes; i++)
+        {
+            int head = mirror->head_segments[i];
+            trails->starts[head] = world->trails.starts[head];
+            trails->ends[head] = world->trails.ends[head];
+        }
+    }
+
+    int count = world->trails.count;
+    TRON_ReserveTrails(trails, count);
+    SDL_memcpy(trails->starts + first, world->trails.starts + first, (count - first) * sizeof(SDL_Point));
+    SDL_memcpy(trails->ends + first, world->trails.ends + first, (count - first) * sizeof(SDL_Point));
+    SDL_memcpy(trails->owners + first, world->trails.owners + first, (count - first) * sizeof(Uint16));
+    trails->count = count;
+
+    int num_bikes = world->num_bikes;
+    SDL_memcpy(mirror->x, world->x, num_bikes * sizeof(Sint32));
+    SDL_memcpy(mirror->y, world->y, num_bikes * sizeof(Sint32));
+    SDL_memcpy(mirror->speed, world->speed, num_bikes * sizeof(Sint32));
+    SDL_memcpy(mirror->direction, world->direction, num_bikes * sizeof(Uint8));
+    SDL_memcpy(mirror->dead, world->dead, num_bikes * sizeof(bool));
+    SDL_memcpy(mirror->previous_positions, world->previous_positions, num_bikes * sizeof(SDL_Point));
+    SDL_memcpy(mirror->head_segments, world->head_segments, num_bikes * sizeof(int));
+    SDL_memcpy(mirror->last_turn_ticks, world->last_turn_ticks, num_bikes * sizeof(Sint64));
+    SDL_memcpy(mirror->death_ticks, world->death_ticks, num_bikes * sizeof(Uint64));
+    SDL_memcpy(mirror->impacts, world->impacts, num_bikes * sizeof(TRON_Collision));
+
+    mirror->width = world->width;
+    mirror->height = world->height;
+    mirror->num_bikes = num_bikes;
+    mirror->num_alive = world->num_alive;
+    mirror->tick = world->tick;
+    mirror->generation = world->generation;
+    mirror->hash = world->hash;
+}
+
+void TRON_WriteS32s(SDL_IOStream* stream, const Sint32* values, int count)
+{
+    for (int i = 0; i < count; i++) { SDL_WriteS32LE(stream, values[i]); }
+}
+
+void TRON_WriteU64s(SDL_IOStream* stream, const Uint64* values, int count)
+{
+    for (int i = 0; i < count; i++) { SDL_WriteU64LE(stream, values[i]); }
+}
+
+void TRON_WriteBools(SDL_IOStream* stream, const bool* values, int count)
+{
+    for (int i = 0; i < count; i++) { SDL_WriteU8(stream, values[i] ? 1 : 0); }
+}
+
+void TRON_WritePoints(SDL_IOStream* stream, const SDL_Point* points, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        SDL_WriteS32LE(stream, points[i].x);
+        SDL_WriteS32LE(stream, points[i].y);
+    }
+}
+
+bool TRON_FitsStream(SDL_IOStream* stream, Uint32 count, Sint64 item_size)
+{
+    Sint64 size = SDL_GetIOSize(stream);
+    Sint64 offset = SDL_TellIO(stream);
+    return (size < 0) || (offset < 0) || ((Sint64)count <= (size - offset) / item_size);
+}
+
+bool TRON_ReadS32s(SDL_IOStream* stream, Sint32* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!SDL_ReadS32LE(stream, &values[i])) { return false; }
+    }
+    return true;
+}
+
+bool TRON_ReadU64s(SDL_IOStream* stream, Uint64* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!SDL_ReadU64LE(stream, &values[i])) { return false; }
+    }
+    return true;
+}
+
+bool TRON_ReadBools(SDL_IOStream* stream, bool* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        Uint8 value = 0;
+        if ((!SDL_ReadU8(stream, &value)) || (value > 1)) { return false; }
+        values[i] = value;
+    }
+    return true;
+}
+
+bool TRON_ReadPoints(SDL_IOStream* stream, SDL_Point* points, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if ((!SDL_ReadS32LE(stream, &points[i].x)) || (!SDL_ReadS32LE(stream, &points[i].y))) { return false; }
+    }
+    return true;
+}
+
+bool TRON_IsInRange(const int* values, int count, int min, int max)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if ((values[i] < min) || (values[i] >= max)) { return false; }
+    }
+    return true;
+}
+
+void TRON_WriteGrid(TRON_Grid* grid, SDL_IOStream* stream)
+{
+    int num_cells = grid->width * grid->height;
+    int num_words = (num_cells + 63) / 64;
+
+    Uint32 num_set = 0;
+    for (int i = 0; i < num_words; i++) { num_set += grid->occupied[i] != 0; }
+    SDL_WriteU32LE(stream, num_set);
+    for (int i = 0; i < num_words; i++)
+    {
+        if (grid->occupied[i] == 0) { continue; }
+        SDL_WriteU32LE(stream, i);
+        SDL_WriteU64LE(stream, grid->occupied[i]);
+    }
+
+    int run_segment = -1;
+    Uint32 run_length = 0;
+    for (int i = 0; i < num_cells; i++)
+    {
+        if (!((grid->occupied[i >> 6] >> (i & 63)) & 1)) { continue; }
+        if ((grid->segments[i] != run_segment) && (run_length > 0))
+        {
+            SDL_WriteU32LE(stream, run_length);
+            SDL_WriteU32LE(stream, run_segment);
+            run_length = 0;
+        }
+        run_segment = grid->segments[i];
+        run_length++;
+    }
+    if (run_length > 0)
+    {
+        SDL_WriteU32LE(stream, run_length);
+        SDL_WriteU32LE(stream, run_segment);
+    }
+
+    TRON_WriteS32s(stream, grid->column_rays, grid->width);
+    TRON_WriteS32s(stream, grid->row_rays, grid->height);
+}
+
+bool TRON_ReadGrid(TRON_Grid* grid, SDL_IOStream* stream, int num_segments)
+{
+    int num_cells = grid->width * grid->height;
+    int num_words = (num_cells + 63) / 64;
+    Uint64 last_mask = (num_cells & 63) ? ((Uint64)1 << (num_cells & 63)) - 1 : SDL_MAX_UINT64;
+    SDL_memset(grid->occupied, 0, num_words * sizeof(Uint64));
+    grid->num_stamps = 0;
+
+    Uint32 num_set = 0;
+    Uint64 total = 0;
+    Sint64 previous = -1;
+    if (!SDL_ReadU32LE(stream, &num_set)) { return false; }
+    for (Uint32 k = 0; k < num_set; k++)
+    {
+        Uint32 i = 0;
+        Uint64 word = 0;
+        if ((!SDL_ReadU32LE(stream, &i)) || (!SDL_ReadU64LE(stream, &word)) || ((Sint64)i <= previous) || (i >= (Uint32)num_words)) { return false; }
+        if ((i == (Uint32)num_words - 1) && (word & ~last_mask)) { return false; }
+        previous = i;
+        grid->occupied[i] = word;
+        total += SDL_CountOneBits((Uint32)word) + SDL_CountOneBits((Uint32)(word >> 32));
+    }
+
+    int cell = 0;
+    while (total > 0)
+    {
+        Uint32 run_length = 0;
+        Uint32 segment = 0;
+        if ((!SDL_ReadU32LE(stream, &run_length)) || (!SDL_ReadU32LE(stream, &segment)) || (run_length == 0) || (run_length > total) || (segment >= (Uint32)num_segments)) { return false; }
+        total -= run_length;
+        for (; run_length > 0; cell++)
+        {
+            if (!TRON_IsCellOccupied(grid, cell % grid->width, cell / grid->width)) { continue; }
+            grid->segments[cell] = segment;
+            run_length--;
+        }
+    }
+
+    return TRON_ReadS32s(stream, grid->column_rays, grid->width) && TRON_ReadS32s(stream, grid->row_rays, grid->height);
+}
+
+void TRON_SaveWorld(TRON_World* world, SDL_IOStream* stream)
+{
+    int n = world->num_bikes;
+    SDL_WriteU32LE(stream, n);
+    SDL_WriteU32LE(stream, world->num_alive);
+    SDL_WriteU64LE(stream, world->tick);
+    SDL_WriteU64LE(stream, world->checked_tick);
+
+    TRON_WriteS32s(stream, world->x, n);
+    TRON_WriteS32s(stream, world->y, n);
+    TRON_WriteS32s(stream, world->speed, n);
+    SDL_WriteIO(stream, world->direction, n * sizeof(Uint8));
+    TRON_WriteBools(stream, world->dead, n);
+    TRON_WritePoints(stream, world->previous_positions, n);
+    TRON_WritePoints(stream, world->checked_positions, n);
+    for (int i = 0; i < n; i++)
+    {
+        const SDL_Rect* rect = &world->checked_rects[i];
+        SDL_WriteS32LE(stream, rect->x);
+        SDL_WriteS32LE(stream, rect->y);
+        SDL_WriteS32LE(stream, rect->w);
+        SDL_WriteS32LE(stream, rect->h);
+    }
+    TRON_WriteS32s(stream, world->checked_segments, n);
+    TRON_WriteS32s(stream, world->head_segments, n);
+    TRON_WriteS32s(stream, world->previous_segments, n);
+    for (int i = 0; i < n; i++) { SDL_WriteS64LE(stream, world->last_turn_ticks[i]); }
+    TRON_WriteU64s(stream, world->death_ticks, n);
+    for (int i = 0; i < n; i++)
+    {
+        const TRON_Collision* impact = &world->impacts[i];
+        SDL_WriteS32LE(stream, impact->time);
+        TRON_WritePoints(stream, &impact->point, 1);
+        SDL_WriteS32LE(stream, impact->other);
+    }
+    TRON_WriteU64s(stream, world->predicted_ticks, n);
+    TRON_WriteBools(stream, world->ray_vertical, n);
+    SDL_WriteIO(stream, world->ray_counts, n * sizeof(Uint8));
+    TRON_WriteS32s(stream, world->ray_ends, n);
+    TRON_WriteS32s(stream, world->ray_lines, n * TRON_RAY_LINES);
+    TRON_WriteS32s(stream, world->ray_nexts, n * TRON_RAY_LINES);
+    TRON_WriteS32s(stream, world->ray_prevs, n * TRON_RAY_LINES);
+    SDL_WriteU32LE(stream, world->sap_count);
+    TRON_WriteS32s(stream, world->sap_order, world->sap_count);
+
+    SDL_WriteU32LE(stream, world->trails.count);
+    TRON_WritePoints(stream, world->trails.starts, world->trails.count);
+    TRON_WritePoints(stream, world->trails.ends, world->trails.count);
+    for (int i = 0; i < world->trails.count; i++) { SDL_WriteU16LE(stream, world->trails.owners[i]); }
+
+    SDL_WriteU32LE(stream, world->events.count);
+    TRON_WriteU64s(stream, world->events.ticks, world->events.count);
+    TRON_WriteS32s(stream, world->events.bikes, world->events.count);
+
+    TRON_WriteGrid(&world->grid, stream);
+}
+
+bool TRON_ReadArray(SDL_IOStream* stream, void* data, size_t size)
+{
+    return SDL_ReadIO(stream, data, size) == size;
+}
+
+bool TRON_IsRayNode(TRON_World* world, int node, bool vertical, int line)
+{
+    if (node < 0) { return true; }
+    if (node >= world->num_bikes * TRON_RAY_LINES) { return false; }
+
+    int index = node / TRON_RAY_LINES;
+    return (node % TRON_RAY_LINES < world->ray_counts[index]) && (world->ray_vertical[index] == vertical) && (world->ray_lines[node] == line);
+}
+
+bool TRON_AreRaysValid(TRON_World* world)
+{
+    TRON_Grid* grid = &world->grid;
+
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        bool vertical = world->ray_vertical[i];
+        int* heads = vertical ? grid->column_rays : grid->row_rays;
+        int num_lines = vertical ? grid->width : grid->height;
+        if (world->ray_counts[i] > TRON_RAY_LINES) { return false; }
+
+        for (int k = 0; k < world->ray_counts[i]; k++)
+        {
+            int node = i * TRON_RAY_LINES + k;
+            int line = world->ray_lines[node];
+            int prev = world->ray_prevs[node];
+            int next = world->ray_nexts[node];
+            if ((line < 0) || (line >= num_lines)) { return false; }
+            if ((!TRON_IsRayNode(world, prev, vertical, line)) || (!TRON_IsRayNode(world, next, vertical, line))) { return false; }
+            if ((prev >= 0) ? (world->ray_nexts[prev] != node) : (heads[line] != node)) { return false; }
+            if ((next >= 0) && (world->ray_prevs[next] != node)) { return false; }
+        }
+    }
+    for (int x = 0; x < grid->width; x++)
+    {
+        int node = grid->column_rays[x];
+        if ((!TRON_IsRayNode(world, node, true, x)) || ((node >= 0) && (world->ray_prevs[node] >= 0))) { return false; }
+    }
+    for (int y = 0; y < grid->height; y++)
+    {
+        int node = grid->row_rays[y];
+        if ((!TRON_IsRayNode(world, node, false, y)) || ((node >= 0) && (world->ray_prevs[node] >= 0))) { return false; }
+    }
+
+    return true;
+}
+
+bool TRON_IsPointInArena(TRON_World* world, SDL_Point point)
+{
+    return (point.x >= -TRON_FIXED_BIKE_HEIGHT) && (point.y >= -TRON_FIXED_BIKE_HEIGHT) &&
+           (point.x <= world->width + TRON_FIXED_BIKE_HEIGHT) && (point.y <= world->height + TRON_FIXED_BIKE_HEIGHT);
+}
+
+bool TRON_IsRectInArena(TRON_World* world, const SDL_Rect* rect)
+{
+    return TRON_IsPointInArena(world, (SDL_Point){rect->x, rect->y}) && (rect->w >= 0) && (rect->h >= 0) &&
+           (rect->w <= TRON_FIXED_BIKE_HEIGHT) && (rect->h <= TRON_FIXED_BIKE_HEIGHT);
+}
+
+bool TRON_IsWorldValid(TRON_World* world)
+{
+    int n = world->num_bikes;
+    int num_segments = world->trails.count;
+
+    for (int i = 0; i < n; i++)
+    {
+        if ((world->direction[i] > TRON_WEST) || (world->impacts[i].other < -1) || (world->impacts[i].other >= n)) { return false; }
+        if ((world->speed[i] < 0) || (world->speed[i] > SDL_max(world->width, world->height))) { return false; }
+        if ((!TRON_IsPointInArena(world, (SDL_Point){world->x[i], world->y[i]})) || (!TRON_IsPointInArena(world, world->previous_positions[i])) ||
+            (!TRON_IsPointInArena(world, world->checked_positions[i])) || (!TRON_IsRectInArena(world, &world->checked_rects[i])))
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < num_segments; i++)
+    {
+        if (world->trails.owners[i] >= n) { return false; }
+        if ((!TRON_IsPointInArena(world, world->trails.starts[i])) || (!TRON_IsPointInArena(world, world->trails.ends[i]))) { return false; }
+    }
+
+    return TRON_IsInRange(world->checked_segments, n, 0, num_segments) && TRON_IsInRange(world->head_segments, n, 0, num_segments) &&
+           TRON_IsInRange(world->previous_segments, n, -1, num_segments) && TRON_IsInRange(world->sap_order, world->sap_count, 0, n) &&
+           TRON_IsInRange(world->events.bikes, world->events.count, 0, n) && TRON_AreRaysValid(world);
+}
+
+bool TRON_ReadWorld(TRON_World* world, SDL_IOStream* stream)
+{
+    Uint32 n = 0;
+    Uint32 num_alive = 0;
+    if ((!SDL_ReadU32LE(stream, &n)) || (n < 1) || (n > TRON_MAX_WORLD_BIKES)) { return false; }
+    if ((int)n > world->capacity)
+    {
+        TRON_FreeBikes(world);
+        TRON_AllocateBikes(world, n);
+    }
+    world->num_bikes = n;
+    world->turns.count = 0;
+    world->generation++;
+    world->round++;
+    BOX_ReserveBoxes(&world->hulls, n);
+    BOX_ReserveBoxes(&world->fresh_trails, 2 * n);
+    world->fresh_trails.count = 2 * n;
+    for (Uint32 i = 0; i < n; i++)
+    {
+        world->moved[i] = 0;
+        world->dying[i] = false;
+        world->due[i] = false;
+    }
+
+    bool ok = SDL_ReadU32LE(stream, &num_alive) && (num_alive <= n) && SDL_ReadU64LE(stream, &world->tick) && SDL_ReadU64LE(stream, &world->checked_tick);
+    world->num_alive = num_alive;
+    ok = ok && TRON_ReadS32s(stream, world->x, n);
+    ok = ok && TRON_ReadS32s(stream, world->y, n);
+    ok = ok && TRON_ReadS32s(stream, world->speed, n);
+    ok = ok && TRON_ReadArray(stream, world->direction, n * sizeof(Uint8));
+    ok = ok && TRON_ReadBools(stream, world->dead, n);
+    ok = ok && TRON_ReadPoints(stream, world->previous_positions, n);
+    ok = ok && TRON_ReadPoints(stream, world->checked_positions, n);
+    for (Uint32 i = 0; (ok) && (i < n); i++)
+    {
+        SDL_Rect* rect = &world->checked_rects[i];
+        ok = SDL_ReadS32LE(stream, &rect->x) && SDL_ReadS32LE(stream, &rect->y) && SDL_ReadS32LE(stream, &rect->w) && SDL_ReadS32LE(stream, &rect->h);
+    }
+    ok = ok && TRON_ReadS32s(stream, world->checked_segments, n);
+    ok = ok && TRON_ReadS32s(stream, world->head_segments, n);
+    ok = ok && TRON_ReadS32s(stream, world->previous_segments, n);
+    for (Uint32 i = 0; (ok) && (i < n); i++) { ok = SDL_ReadS64LE(stream, &world->last_turn_ticks[i]); }
+    ok = ok && TRON_ReadU64s(stream, world->death_ticks, n);
+    for (Uint32 i = 0; (ok) && (i < n); i++)
+    {
+        TRON_Collision* impact = &world->impacts[i];
+        ok = SDL_ReadS32LE(stream, &impact->time) && TRON_ReadPoints(stream, &impact->point, 1) && SDL_ReadS32LE(stream, &impact->other);
+    }
+    ok = ok && TRON_ReadU64s(stream, world->predicted_ticks, n);
+    ok = ok && TRON_ReadBools(stream, world->ray_vertical, n);
+    ok = ok && TRON_ReadArray(stream, world->ray_counts, n * sizeof(Uint8));
+    ok = ok && TRON_ReadS32s(stream, world->ray_ends, n);
+    ok = ok && TRON_ReadS32s(stream, world->ray_lines, n * TRON_RAY_LINES);
+    ok = ok && TRON_ReadS32s(stream, world->ray_nexts, n * TRON_RAY_LINES);
+    ok = ok && TRON_ReadS32s(stream, world->ray_prevs, n * TRON_RAY_LINES);
+
+    Uint32 count = 0;
+    ok = ok && SDL_ReadU32LE(stream, &count) && (count <= n);
+    world->sap_count = ok ? count : 0;
+    ok = ok && TRON_ReadS32s(stream, world->sap_order, count);
+
+    ok = ok && SDL_ReadU32LE(stream, &count) && (count >= n) && (count <= SDL_MAX_SINT32 / 2) && (TRON_FitsStream(stream, count, 18));
+    world->trails.count = 0;
+    if (!ok) { return false; }
+    TRON_ReserveTrails(&world->trails, count);
+    world->trails.count = count;
+    ok = ok && TRON_ReadPoints(stream, world->trails.starts, count);
+    ok = ok && TRON_ReadPoints(stream, world->trails.ends, count);
+    for (Uint32 i = 0; (ok) && (i < count); i++) { ok = SDL_ReadU16LE(stream, &world->trails.owners[i]); }
+
+    ok = ok && SDL_ReadU32LE(stream, &count) && (count <= SDL_MAX_SINT32 / 2) && (TRON_FitsStream(stream, count, 12));
+    world->events.count = 0;
+    if (!ok) { return false; }
+    TRON_ReserveEvents(&world->events, count);
+    world->events.count = count;
+    ok = ok && TRON_ReadU64s(stream, world->events.ticks, count);
+    ok = ok && TRON_ReadS32s(stream, world->events.bikes, count);
+
+    return (ok) && (TRON_ReadGrid(&world->grid, stream, world->trails.count)) && (TRON_IsWorldValid(world));
+}
+
+void TRON_LinkSegments(TRON_World* world)
+{
+    TRON_Trails* trails = &world->trails;
+    int* lasts = SDL_malloc(world->num_bikes * sizeof(int));
+    SDL_memset(lasts, 0xFF, world->num_bikes * sizeof(int));
+
+    for (int i = 0; i < trails->count; i++)
+    {
+        int owner = trails->owners[i];
+        trails->nexts[i] = -1;
+        if (lasts[owner] >= 0) { trails->nexts[lasts[owner]] = i; }
+        lasts[owner] = i;
+    }
+    SDL_free(lasts);
+}
+
+bool TRON_LoadWorld(TRON_World* world, SDL_IOStream* stream)
+{
+    if (!TRON_ReadWorld(world, stream))
+    {
+        TRON_ResetWorld(world, world->num_bikes);
+        return false;
+    }
+
+    TRON_LinkSegments(world);
+    TRON_RehashWorld(world);
+    return true;
+}
+
+void TRON_CopyBikes(TRON_World* destination, const TRON_World* source)
+{
+    int n = source->num_bikes;
+    SDL_memcpy(destination->x, source->x, n * sizeof(Sint32));
+    SDL_memcpy(destination->y, source->y, n * sizeof(Sint32));
+    SDL_memcpy(destination->speed, source->speed, n * sizeof(Sint32));
+    SDL_memcpy(destination->direction, source->direction, n * sizeof(Uint8));
+    SDL_memcpy(destination->dead, source->dead, n * sizeof(bool));
+    SDL_memcpy(destination->previous_positions, source->previous_positions, n * sizeof(SDL_Point));
+    SDL_memcpy(destination->checked_positions, source->checked_positions, n * sizeof(SDL_Point));
+    SDL_memcpy(destination->checked_rects, source->checked_rects, n * sizeof(SDL_Rect));
+    SDL_memcpy(destination->checked_segments, source->checked_segments, n * sizeof(int));
+    SDL_memcpy(destination->head_segments, source->head_segments, n * sizeof(int));
+    SDL_memcpy(destination->previous_segments, source->previous_segments, n * sizeof(int));
+    SDL_memcpy(destination->last_turn_ticks, source->last_turn_ticks, n * sizeof(Sint64));
+    SDL_memcpy(destination->death_ticks, source->death_ticks, n * sizeof(Uint64));
+    SDL_memcpy(destination->impacts, source->impacts, n * sizeof(TRON_Collision));
+    SDL_memcpy(destination->predicted_ticks, source->predicted_ticks, n * sizeof(Uint64));
+    SDL_memcpy(destination->ray_vertical, source->ray_vertical, n * sizeof(bool));
+    SDL_memcpy(destination->ray_counts, source->ray_counts, n * sizeof(Uint8));
+    SDL_memcpy(destination->ray_ends, source->ray_ends, n * sizeof(int));
+    SDL_memcpy(destination->ray_lines, source->ray_lines, n * TRON_RAY_LINES * sizeof(int));
+    SDL_memcpy(destination->bike_hashes, source->bike_hashes, n * sizeof(Uint64));
+    SDL_memcpy(destination->sap_order, source->sap_order, source->sap_count * sizeof(int));
+
+    destination->num_bikes = n;
+    destination->num_alive = source->num_alive;
+    destination->sap_count = source->sap_count;
+    destination->tick = source->tick;
+    destination->checked_tick = source->checked_tick;
+    destination->hash = source->hash;
+}
+
+void TRON_CopyEvents(TRON_Events* destination, const TRON_Events* source)
+{
+    destination->count = source->count;
+    if (source->count == 0) { return; }
+
+    TRON_ReserveEvents(destination, source->count);
+    SDL_memcpy(destination->ticks, source->ticks, source->count * sizeof(Uint64));
+    SDL_memcpy(destination->bikes, source->bikes, source->count * sizeof(int));
+}
+
+void TRON_CopyTurns(TRON_Turns* destination, const TRON_Turns* source)
+{
+    destination->count = source->count;
+    if (source->count == 0) { return; }
+
+    TRON_ReserveTurns(destination, source->count);
+    SDL_memcpy(destination->bikes, source->bikes, source->count * sizeof(int));
+    SDL_memcpy(destination->directions, source->directions, source->count * sizeof(Uint8));
+    SDL_memcpy(destination->fractions, source->fractions, source->count * sizeof(int));
+}
+
+TRON_Snapshot* TRON_CreateSnapshot(void)
+{
+    return SDL_calloc(1, sizeof(TRON_Snapshot));
+}
+
+void TRON_DestroySnapshot(TRON_Snapshot* snapshot)
+{
+    if (!snapshot) { return; }
+
+    TRON_FreeBikes(&snapshot->bikes);
+    TRON_QuitEvents(&snapshot->bikes.events);
+    TRON_QuitTurns(&snapshot->bikes.turns);
+    SDL_free(snapshot->head_starts);
+    SDL_free(snapshot->head_ends);
+    SDL_free(snapshot);
+}
+
+void TRON_SaveSnapshot(TRON_World* world, TRON_Snapshot* snapshot)
+{
+    TRON_World* saved = &snapshot->bikes;
+    if (saved->capacity < world->num_bikes)
+    {
+        TRON_FreeBikes(saved);
+        TRON_AllocateBikes(saved, world->capacity);
+        snapshot->head_starts = SDL_realloc(snapshot->head_starts, world->capacity * sizeof(SDL_Point));
+        snapshot->head_ends = SDL_realloc(snapshot->head_ends, world->capacity * sizeof(SDL_Point));
+    }
+
+    TRON_CopyBikes(saved, world);
+    TRON_CopyEvents(&saved->events, &world->events);
+    TRON_CopyTurns(&saved->turns, &world->turns);
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        int head = world->head_segments[i];
+        snapshot->head_starts[i] = world->trails.starts[head];
+        snapshot->head_ends[i] = world->trails.ends[head];
+    }
+    snapshot->num_segments = world->trails.count;
+    snapshot->num_stamps = world->grid.num_stamps;
+    snapshot->round = world->round;
+}
+
+bool TRON_RestoreSnapshot(TRON_World* world, const TRON_Snapshot* snapshot)
+{
+    const TRON_World* saved = &snapshot->bikes;
+    if ((snapshot->round != world->round) || (saved->num_bikes != world->num_bikes) ||
+        (snapshot->num_segments > world->trails.count) || (snapshot->num_stamps > world->grid.num_stamps))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        TRON_UnlinkRay(world, i);
+    }
+    TRON_UndoStamps(&world->grid, snapshot->num_stamps);
+    TRON_CopyBikes(world, saved);
+    TRON_CopyEvents(&world->events, &saved->events);
+    TRON_CopyTurns(&world->turns, &saved->turns);
+
+    world->trails.count = snapshot->num_segments;
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        int head = world->head_segments[i];
+        world->trails.starts[head] = snapshot->head_starts[i];
+        world->trails.ends[head] = snapshot->head_ends[i];
+        world->trails.nexts[head] = -1;
+        world->moved[i] = 0;
+        world->dying[i] = false;
+        world->due[i] = false;
+
+        int count = world->ray_counts[i];
+        int first = world->ray_lines[i * TRON_RAY_LINES];
+        if (count > 0) { TRON_LinkRay(world, i, world->ray_vertical[i], first, first + count - 1); }
+    }
+    world->generation++;
+
+    return true;
+}
+
+void TRON_ResetWorld(TRON_World* world, int num_bikes)
+{
+    TRON_SpawnBikes(world, SDL_clamp(num_bikes, 1, TRON_MAX_WORLD_BIKES));
+    TRON_ClearGrid(&world->grid);
+    world->tick = 0;
+}
+
+void TRON_SetBikeStart(TRON_World* world, int bike, SDL_FPoint position, TRON_Direction direction)
+{
+    if (world->tick != 0) { return; }
+    TRON_PlaceBike(world, bike, TRON_ToFixedPoint(position), direction);
+}
+
+void TRON_MoveBike(TRON_World* world, int index, Sint32 distance)
+{
+    SDL_Point previous = {world->x[index], world->y[index]};
+
+    world->x[index] += TRON_DIRECTION_X[world->direction[index]] * distance;
+    world->y[index] += TRON_DIRECTION_Y[world->direction[index]] * distance;
+
+    SDL_Point position = {world->x[index], world->y[index]};
+    TRON_SetSegmentEnd(world, world->head_segments[index], position);
+    TRON_UpdateBikeHash(world, index);
+    TRON_StampTrail(world, previous, position, world->head_segments[index]);
+}
+
+void TRON_RunJob(TRON_World* world, JOB_Function function, int count)
+{
+    if (count < TRON_MIN_PARALLEL_BIKES)
+    {
+        function(world, 0, count);
+        return;
+    }
+    if ((!world->pool) && (world->num_threads != 1))
+    {
+        int num_threads = world->num_threads > 0 ? world->num_threads : SDL_GetNumLogicalCPUCores();
+        world->pool = JOB_CreatePool(SDL_min(num_threads - 1, TRON_MAX_WORKERS));
+        world->num_threads = JOB_GetNumWorkers(world->pool) + 1;
+    }
+    JOB_Run(world->pool, function, world, count);
+}
+
+Sint32 TRON_GetFractionDistance(TRON_World* world, int index, int fraction)
+{
+    return (Sint32)((Sint64)world->speed[index] * fraction / TRON_TURN_FRACTION_STEPS);
+}
+
+void TRON_AdvanceBikes(void* data, int first, int last)
+{
+    TRON_World* world = data;
+
+    for (int i = first; i < last; i++)
+    {
+        if (world->last_turn_ticks[i] == (Sint64)world->tick) { continue; }
+        world->previous_positions[i] = (SDL_Point){world->x[i], world->y[i]};
+    }
+    for (int i = first; i < last; i++)
+    {
+        Sint32 step = world->dead[i] ? 0 : world->speed[i] - TRON_GetFractionDistance(world, i, world->moved[i]);
+        world->x[i] += TRON_DIRECTION_X[world->direction[i]] * step;
+        world->y[i] += TRON_DIRECTION_Y[world->direction[i]] * step;
+        world->moved[i] = 0;
+    }
+}
+
+void TRON_MoveBikes(TRON_World* world)
+{
+    int num_bikes = world->num_bikes;
+
+    TRON_RunJob(world, TRON_AdvanceBikes, num_bikes);
+    for (int i = 0; i < num_bikes; i++)
+    {
+        if (world->dead[i]) { continue; }
+
+        SDL_Point position = {world->x[i], world->y[i]};
+        TRON_SetSegmentEnd(world, world->head_segments[i], position);
+        TRON_UpdateBikeHash(world, i);
+        TRON_StampTrail(world, world->previous_positions[i], position, world->head_segments[i]);
+    }
+}
+
+bool TRON_CanTurn(TRON_World* world, int index, TRON_Direction direction)
+{
+    if ((world->dead[index]) || ((Sint64)world->tick - world->last_turn_ticks[index] < TRON_TURN_COOLDOWN_TICKS))
+    {
+        return false;
+    }
+    int current = world->direction[index];
+    return ((int)direction != current) && ((int)direction != (current + 2) % 4);
+}
+
+void TRON_StartSegment(TRON_World* world, int index, TRON_Direction direction)
+{
+    SDL_Point position = {world->x[index], world->y[index]};
+    world->previous_segments[index] = world->head_segments[index];
+    world->head_segments[index] = TRON_AppendSegment(world, index, position);
+    world->trails.nexts[world->previous_segments[index]] = world->head_segments[index];
+    world->direction[index] = direction;
+    world->previous_positions[index] = position;
+    world->last_turn_ticks[index] = world->tick;
+    TRON_MoveBike(world, index, direction % 2 == 0 ? TRON_FIXED_BIKE_HEIGHT / 4 : TRON_FIXED_BIKE_WIDTH / 4);
+}
+
+bool TRON_TurnBike(TRON_World* world, int index, TRON_Direction direction)
+{
+    if (!TRON_CanTurn(world, index, direction)) { return false; }
+
+    TRON_StartSegment(world, index, direction);
+    TRON_ScheduleBike(world, index, world->tick + 1);
+
+    return true;
+}
+
+void TRON_QueueTurn(TRON_World* world, int bike, TRON_Direction direction, int fraction)
+{
+    TRON_Turns* turns = &world->turns;
+    TRON_ReserveTurns(turns, turns->count + 1);
+
+    fraction = SDL_clamp(fraction, 0, TRON_TURN_FRACTION_STEPS - 1);
+    int i = turns->count++;
+    while ((i > 0) && (turns->fractions[i - 1] > fraction))
+    {
+        turns->bikes[i] = turns->bikes[i - 1];
+        turns->directions[i] = turns->directions[i - 1];
+        turns->fractions[i] = turns->fractions[i - 1];
+        i--;
+    }
+    turns->bikes[i] = bike;
+    turns->directions[i] = direction;
+    turns->fractions[i] = fraction;
+}
+
+void TRON_ApplyTurns(TRON_World* world)
+{
+    TRON_Turns* turns = &world->turns;
+
+    for (int k = 0; k < turns->count; k++)
+    {
+        int i = turns->bikes[k];
+        if ((i >= world->num_bikes) || (!TRON_CanTurn(world, i, turns->directions[k]))) { continue; }
+
+        TRON_MoveBike(world, i, TRON_GetFractionDistance(world, i, turns->fractions[k]) - TRON_GetFractionDistance(world, i, world->moved[i]));
+        world->moved[i] = turns->fractions[k];
+        TRON_StartSegment(world, i, turns->directions[k]);
+        TRON_ScheduleBike(world, i, world->tick);
+    }
+    turns->count = 0;
+}
+
+SDL_Rect TRON_GetTrailRect(SDL_Point p1, SDL_Point p2)
+{
+    SDL_Rect seg_rect;
+    if (p1.x == p2.x)
+    {
+        seg_rect.x = p1.x - TRON_FIXED_TRAIL_SIZE / 2;
+        seg_rect.y = SDL_min(p1.y, p2.y);
+        seg_rect.w = TRON_FIXED_TRAIL_SIZE;
+        seg_rect.h = SDL_abs(p2.y - p1.y);
+    }
+    else
+    {
+        seg_rect.x = SDL_min(p1.x, p2.x);
+        seg_rect.y = p1.y - TRON_FIXED_TRAIL_SIZE / 2;
+        seg_rect.w = SDL_abs(p2.x - p1.x);
+        seg_rect.h = TRON_FIXED_TRAIL_SIZE;
+    }
+    return seg_rect;
+}
+
+bool TRON_IsRecentSegment(TRON_World* world, int index, int segment)
+{
+    return (segment == world->head_segments[index]) || (segment == world->previous_segments[index]);
+}
+
+bool TRON_GetCheckedTrail(TRON_World* world, int segment, SDL_Rect* rect)
+{
+    int owner = world->trails.owners[segment];
+    SDL_Point end = world->trails.ends[segment];
+
+    if (segment == world->checked_segments[owner]) { end = world->checked_positions[owner]; }
+    else if (segment == world->head_segments[owner]) { return false; }
+
+    *rect = TRON_GetTrailRect(world->trails.starts[segment], end);
+    return (rect->w > 0) && (rect->h > 0);
+}
+
+TRON_Sweep TRON_GetSweep(TRON_World* world, int index)
+{
+    TRON_Sweep sweep;
+    int direction = world->direction[index];
+    const SDL_Rect* checked = &world->checked_rects[index];
+    sweep.rect = TRON_GetBikeBounds(world, index);
+    sweep.sign = TRON_GetDirectionSign(direction);
+    sweep.front = TRON_GetRectFront(checked, direction);
+    sweep.length = SDL_max((TRON_GetRectFront(&sweep.rect, direction) - sweep.front) * sweep.sign, 0);
+    sweep.back = 0;
+    if (world->checked_segments[index] != world->head_segments[index])
+    {
+        sweep.back = SDL_max((sweep.front - TRON_GetRectFront(&sweep.rect, (direction + 2) % 4)) * sweep.sign, 0);
+    }
+
+    Sint32 x1 = SDL_min(sweep.rect.x, checked->x);
+    Sint32 y1 = SDL_min(sweep.rect.y, checked->y);
+    Sint32 x2 = SDL_max(sweep.rect.x + sweep.rect.w, checked->x + checked->w);
+    Sint32 y2 = SDL_max(sweep.rect.y + sweep.rect.h, checked->y + checked->h);
+    sweep.hull = (SDL_Rect){x1, y1, x2 - x1, y2 - y1};
+
+    return sweep;
+}
+
+SDL_Point TRON_GetSweepPoint(TRON_World* world, int index, const TRON_Sweep* sweep, Sint32 distance)
+{
+    Sint32 front = sweep->front + sweep->sign * distance;
+
+    if (world->direction[index] % 2 == 0)
+    {
+        return (SDL_Point){sweep->rect.x + sweep->rect.w / 2, front};
+    }
+    return (SDL_Point){front, sweep->rect.y + sweep->rect.h / 2};
+}
+
+Sint32 TRON_GetSweepTime(TRON_World* world, int index, const TRON_Sweep* sweep, SDL_Point point)
+{
+    Sint32 reached = ((world->direction[index] % 2 == 0 ? point.y : point.x) - sweep->front) * sweep->sign;
+
+    if ((sweep->length <= 0) || (reached <= 0)) { return 0; }
+    return SDL_min(TRON_GetTime(reached, sweep->length), TRON_TIME_ONE);
+}
+
+bool TRON_SweepWalls(TRON_World* world, int index, const TRON_Sweep* sweep, Sint32* distance)
+{
+    const SDL_Rect* r = &sweep->rect;
+    int direction = world->direction[index];
+
+    if (((direction != TRON_WEST) && (r->x < 0)) || ((direction != TRON_NORTH) && (r->y < 0)) ||
+        ((direction != TRON_EAST) && (r->x + r->w > world->width)) || ((direction != TRON_SOUTH) && (r->y + r->h > world->height)))
+    {
+        *distance = 0;
+        return true;
+    }
+
+    Sint32 limit = (direction == TRON_NORTH) || (direction == TRON_WEST) ? 0 : (direction == TRON_EAST ? world->width : world->height);
+    Sint32 remaining = (limit - sweep->front) * sweep->sign;
+    *distance = SDL_max(remaining, 0);
+
+    return remaining < sweep->length;
+}
+
+void TRON_GetSweepLines(TRON_World* world, int index, const TRON_Sweep* sweep, int* first, int* last)
+{
+    bool vertical = world->direction[index] % 2 == 0;
+    Sint32 lateral = vertical ? sweep->rect.x : sweep->rect.y;
+    Sint32 extent = vertical ? sweep->rect.w : sweep->rect.h;
+    *first = SDL_max(TRON_GetGridCell(lateral - TRON_HALF_TRAIL_SIZE), 0);
+    *last = SDL_min(TRON_GetGridCell(lateral + extent + TRON_HALF_TRAIL_SIZE), (vertical ? world->grid.width : world->grid.height) - 1);
+}
+
+Sint32 TRON_GetCellDistance(const TRON_Sweep* sweep, int cell)
+{
+    Sint32 edge = (sweep->sign > 0 ? cell : cell + 1) * TRON_FIXED_TRAIL_SIZE;
+    return (edge - sweep->front) * sweep->sign - TRON_HALF_TRAIL_SIZE;
+}
+
+bool TRON_SweepSegment(TRON_World* world, int index, const TRON_Sweep* sweep, int segment, int cell, bool predict, Sint32* distance)
+{
+    int owner = world->trails.owners[segment];
+    SDL_Rect trail;
+    if ((world->dead[owner]) || ((owner == index) && (TRON_IsRecentSegment(world, index, segment)))) { return false; }
+    if ((predict) && (segment == world->head_segments[owner]))
+    {
+        *distance = SDL_max(TRON_GetCellDistance(sweep, cell), 0);
+        return true;
+    }
+    if (!TRON_GetCheckedTrail(world, segment, &trail)) { return false; }
+
+    bool vertical = world->direction[index] % 2 == 0;
+    Sint32 lateral = vertical ? sweep->rect.x : sweep->rect.y;
+    Sint32 extent = vertical ? sweep->rect.w : sweep->rect.h;
+    Sint32 t1 = vertical ? trail.x : trail.y;
+    Sint32 t2 = t1 + (vertical ? trail.w : trail.h);
+    Sint32 a1 = vertical ? trail.y : trail.x;
+    Sint32 a2 = a1 + (vertical ? trail.h : trail.w);
+    Sint32 nearest = sweep->sign > 0 ? a1 - sweep->front : sweep->front - a2;
+    Sint32 farthest = sweep->sign > 0 ? a2 - sweep->front : sweep->front - a1;
+    if ((t2 <= lateral) || (t1 >= lateral + extent) || (farthest <= -sweep->back)) { return false; }
+
+    *distance = SDL_max(nearest, 0);
+    return true;
+}
+
+int TRON_GetCellSuccessor(const TRON_Trails* trails, int segment, int x, int y)
+{
+    SDL_Point end = trails->ends[segment];
+    return (TRON_GetGridCell(end.x) == x) && (TRON_GetGridCell(end.y) == y) ? trails->nexts[segment] : -1;
+}
+
+bool TRON_SweepGrid(TRON_World* world, int index, const TRON_Sweep* sweep, Sint32 limit, bool predict, Sint32* distance, int* other)
+{
+    TRON_Grid* grid = &world->grid;
+    bool vertical = world->direction[index] % 2 == 0;
+    int size = vertical ? grid->height : grid->width;
+    int first = TRON_GetGridCell(sweep->front - sweep->sign * (sweep->back + TRON_HALF_TRAIL_SIZE));
+    int last = TRON_GetGridCell(sweep->front + sweep->sign * (limit + TRON_HALF_TRAIL_SIZE));
+    int l1;
+    int l2;
+    bool hit = false;
+
+    TRON_GetSweepLines(world, index, sweep, &l1, &l2);
+    *distance = limit;
+    for (int a = first; (a != last + sweep->sign) && (TRON_GetCellDistance(sweep, a) < *distance); a += sweep->sign)
+    {
+        if ((a < 0) || (a >= size)) { continue; }
+
+        for (int l = l1; l <= l2; l++)
+        {
+            int x = vertical ? l : a;
+            int y = vertical ? a : l;
+            if (!TRON_IsCellOccupied(grid, x, y)) { continue; }
+
+            for (int segment = grid->segments[y * grid->width + x]; segment >= 0; segment = TRON_GetCellSuccessor(&world->trails, segment, x, y))
+            {
+                Sint32 entry;
+                if ((TRON_SweepSegment(world, index, sweep, segment, a, predict, &entry)) && (entry < *distance))
+                {
+                    *distance = entry;
+                    *other = world->trails.owners[segment];
+                    hit = true;
+                }
+            }
+        }
+    }
+
+    return hit;
+}
+
+bool TRON_CheckHeadOn(TRON_World* world, int index, const TRON_Sweep* s1, int other, const TRON_Sweep* s2, Sint32* time)
+{
+    int direction = world->direction[index];
+    if ((direction == world->direction[other]) || (direction % 2 != world->direction[other] % 2)) { return false; }
+
+    bool vertical = direction % 2 == 0;
+    Sint32 a1 = vertical ? s1->rect.x : s1->rect.y;
+    Sint32 a2 = vertical ? s2->rect.x : s2->rect.y;
+    Sint32 w1 = vertical ? s1->rect.w : s1->rect.h;
+    Sint32 w2 = vertical ? s2->rect.w : s2->rect.h;
+    if ((a1 + w1 <= a2) || (a2 + w2 <= a1)) { return false; }
+
+    Sint32 gap = (s2->front - s1->front) * s1->sign;
+    Sint32 closing = s1->length + s2->length;
+    Sint32 lengths = vertical ? s1->rect.h + s2->rect.h : s1->rect.w + s2->rect.w;
+    if (gap + lengths <= 0) { return false; }
+    if (gap >= closing) { return false; }
+
+    *time = SDL_max(TRON_GetTime(gap, closing), 0);
+    return true;
+}
+
+void TRON_GetTrailEntry(const SDL_Rect* rect, SDL_Point p1, SDL_Point p2, Sint32* distance, SDL_Point* point)
+{
+    Sint32 dx = p2.x - p1.x;
+    Sint32 dy = p2.y - p1.y;
+    if (dx == 0)
+    {
+        *distance = SDL_max(dy > 0 ? rect->y - p1.y : p1.y - (rect->y + rect->h), 0);
+        *point = (SDL_Point){p1.x, p1.y + (dy > 0 ? *distance : -*distance)};
+    }
+    else
+    {
+        *distance = SDL_max(dx > 0 ? rect->x - p1.x : p1.x - (rect->x + rect->w), 0);
+        *point = (SDL_Point){p1.x + (dx > 0 ? *distance : -*distance), p1.y};
+    }
+}
+
+void TRON_PackFreshTrails(TRON_World* world, int index)
+{
+    BOX_Boxes* boxes = &world->fresh_trails;
+    SDL_Point position = {world->x[index], world->y[index]};
+    SDL_Point checked = world->checked_positions[index];
+    int segment = world->checked_segments[index];
+    int head = world->head_segments[index];
+
+    if (world->dead[index])
+    {
+        BOX_SetEmptyBox(boxes, 2 * index);
+        BOX_SetEmptyBox(boxes, 2 * index + 1);
+    }
+    else if (segment == head)
+    {
+        SDL_Rect rect = TRON_GetTrailRect(checked, position);
+        BOX_SetBox(boxes, 2 * index, &rect);
+        BOX_SetEmptyBox(boxes, 2 * index + 1);
+    }
+    else
+    {
+        SDL_Rect rect1 = TRON_GetTrailRect(checked, world->trails.ends[segment]);
+        SDL_Rect rect2 = TRON_GetTrailRect(world->trails.starts[head], position);
+        BOX_SetBox(boxes, 2 * index, &rect1);
+        BOX_SetBox(boxes, 2 * index + 1, &rect2);
+    }
+}
+
+bool TRON_NewTrailHitsRect(TRON_World* world, int index, const SDL_Rect* rect, Sint32* time, SDL_Point* point)
+{
+    SDL_Point position = {world->x[index], world->y[index]};
+    SDL_Point checked = world->checked_positions[index];
+    int segment = world->checked_segments[index];
+    int head = world->head_segments[index];
+    Sint32 distance;
+
+    if (segment == head)
+    {
+        Sint32 length = SDL_abs(position.x - checked.x) + SDL_abs(position.y - checked.y);
+        if (!BOX_Intersects(&world->fresh_trails, 2 * index, rect)) { return false; }
+
+        TRON_GetTrailEntry(rect, checked, position, &distance, point);
+        *time = TRON_GetTime(distance, length);
+        return true;
+    }
+
+    SDL_Point corner = world->trails.ends[segment];
+    SDL_Point start = world->trails.starts[head];
+    Sint32 length1 = SDL_abs(corner.x - checked.x) + SDL_abs(corner.y - checked.y);
+    Sint32 length2 = SDL_abs(position.x - start.x) + SDL_abs(position.y - start.y);
+    Sint32 length = length1 + length2;
+
+    if (BOX_Intersects(&world->fresh_trails, 2 * index, rect))
+    {
+        TRON_GetTrailEntry(rect, checked, corner, &distance, point);
+        *time = TRON_GetTime(distance, length);
+        return true;
+    }
+    if (BOX_Intersects(&world->fresh_trails, 2 * index + 1, rect))
+    {
+        TRON_GetTrailEntry(rect, start, position, &distance, point);
+        *time = TRON_GetTime(length1 + distance, length);
+        return true;
+    }
+
+    return false;
+}
+
+void TRON_RecordImpact(TRON_Collision* impact, Sint32 time, SDL_Point point, int other)
+{
+    if (time >= impact->time) { return; }
+
+    impact->time = time;
+    impact->point = point;
+    impact->other = other;
+}
+
+bool TRON_CheckBikeCollision(TRON_World* world, int index, TRON_Collision* impact)
+{
+    const TRON_Sweep* s1 = &world->sweeps[index];
+    Sint32 time;
+    SDL_Point point;
+
+    impact->time = 2 * TRON_TIME_ONE;
+
+    for (int k = world->neighbor_offsets[index]; k < world->neighbor_offsets[index + 1]; k++)
+    {
+        int i = world->neighbors[k];
+        const TRON_Sweep* s2 = &world->sweeps[i];
+        if (TRON_CheckHeadOn(world, index, s1, i, s2, &time))
+        {
+            TRON_RecordImpact(impact, time, TRON_GetSweepPoint(world, index, s1, (Sint32)((Sint64)s1->length * time / TRON_TIME_ONE)), i);
+        }
+        if (TRON_NewTrailHitsRect(world, i, &s1->rect, &time, &point))
+        {
+            time = SDL_max(time, TRON_GetSweepTime(world, index, s1, point));
+            TRON_RecordImpact(impact, time, point, i);
+        }
+    }
+
+    if (world->due[index])
+    {
+        Sint32 wall;
+        Sint32 distance;
+        int other;
+
+        if (TRON_SweepWalls(world, index, s1, &wall))
+        {
+            TRON_RecordImpact(impact, TRON_GetTime(wall, s1->length), TRON_GetSweepPoint(world, index, s1, wall), -1);
+        }
+        else
+        {
+            wall = s1->length;
+        }
+        if (TRON_SweepGrid(world, index, s1, wall, false, &distance, &other))
+        {
+            TRON_RecordImpact(impact, TRON_GetTime(distance, s1->length), TRON_GetSweepPoint(world, index, s1, distance), other);
+        }
+    }
+
+    if (impact->time > TRON_TIME_ONE) { return false; }
+
+    impact->time = SDL_min(impact->time, TRON_TIME_ONE);
+    return true;
+}
+
+void TRON_CastRay(TRON_World* world, int index)
+{
+    int direction = world->direction[index];
+    bool vertical = direction % 2 == 0;
+    int sign = TRON_GetDirectionSign(direction);
+    int size = vertical ? world->grid.height : world->grid.width;
+    const SDL_Rect* rect = &world->checked_rects[index];
+    Sint32 front = TRON_GetRectFront(rect, direction);
+    Sint32 limit = sign < 0 ? 0 : (vertical ? world->height : world->width);
+    TRON_Sweep ray = {*rect, *rect, front, SDL_max((limit - front) * sign, 0), 0, sign};
+    Sint32 distance;
+    int other;
+    int l1;
+    int l2;
+
+    TRON_SweepGrid(world, index, &ray, ray.length, true, &distance, &other);
+    TRON_GetSweepLines(world, index, &ray, &l1, &l2);
+    TRON_UnlinkRay(world, index);
+    world->ray_ends[index] = SDL_clamp(TRON_GetGridCell(front + sign * (distance + TRON_HALF_TRAIL_SIZE)), 0, size - 1);
+    TRON_LinkRay(world, index, vertical, l1, l2);
+    world->predicted_ticks[index] = SDL_MAX_UINT64;
+    TRON_ScheduleBike(world, index, TRON_PredictTick(world, index, distance));
+}
+
+void TRON_StopBikeAtImpact(TRON_World* world, int index)
+{
+    const TRON_Sweep* sweep = &world->sweeps[index];
+    SDL_Point start = world->trails.starts[world->head_segments[index]];
+    Sint32 travelled = SDL_abs(world->x[index] - start.x) + SDL_abs(world->y[index] - start.y);
+    Sint32 back = SDL_min((Sint32)((Sint64)sweep->length * (TRON_TIME_ONE - world->impacts[index].time) / TRON_TIME_ONE), travelled);
+
+    world->x[index] -= TRON_DIRECTION_X[world->direction[index]] * back;
+    world->y[index] -= TRON_DIRECTION_Y[world->direction[index]] * back;
+    TRON_SetSegmentEnd(world, world->head_segments[index], (SDL_Point){world->x[index], world->y[index]});
+}
+
+void TRON_PrepareBikes(void* data, int first, int last)
+{
+    TRON_World* world = data;
+
+    for (int i = first; i < last; i++)
+    {
+        world->sweeps[i] = TRON_GetSweep(world, i);
+        TRON_PackFreshTrails(world, i);
+    }
+}
+
+void TRON_SortBikes(TRON_World* world)
+{
+    int* order = world->sap_order;
+    int count = 0;
+
+    for (int k = 0; k < world->sap_count; k++)
+    {
+        if (!world->dead[order[k]]) { order[count++] = order[k]; }
+    }
+    for (int k = 1; k < count; k++)
+    {
+        int bike = order[k];
+        Sint32 key = world->sweeps[bike].hull.x;
+        int j = k - 1;
+        while ((j >= 0) && (world->sweeps[order[j]].hull.x > key))
+        {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = bike;
+    }
+
+    world->sap_count = count;
+    world->hulls.count = count;
+    for (int k = 0; k < count; k++)
+    {
+        BOX_SetBox(&world->hulls, k, &world->sweeps[order[k]].hull);
+    }
+}
+
+void TRON_FindPairs(TRON_World* world)
+{
+    BOX_Boxes* hulls = &world->hulls;
+    int count = world->sap_count;
+    world->pairs.count = 0;
+
+    for (int k = 0; k < count; k++)
+    {
+        const SDL_Rect* hull = &world->sweeps[world->sap_order[k]].hull;
+        int last = k + 1;
+        while ((last < count) && (hulls->min_x[last] <= hulls->max_x[k])) { last++; }
+
+        for (int j = BOX_FindIntersection(hulls, hull, k + 1, last); j >= 0; j = BOX_FindIntersection(hulls, hull, j + 1, last))
+        {
+            TRON_AddPair(&world->pairs, world->sap_order[k], world->sap_order[j]);
+        }
+    }
+}
+
+void TRON_BuildNeighbors(TRON_World* world)
+{
+    TRON_Pairs* pairs = &world->pairs;
+    int* offsets = world->neighbor_offsets;
+    int num_bikes = world->num_bikes;
+
+    SDL_memset(offsets, 0, (num_bikes + 1) * sizeof(int));
+    for (int p = 0; p < pairs->count; p++)
+    {
+        offsets[pairs->first[p] + 1]++;
+        offsets[pairs->second[p] + 1]++;
+    }
+    for (int i = 0; i < num_bikes; i++)
+    {
+        offsets[i + 1] += offsets[i];
+        world->neighbor_cursors[i] = offsets[i];
+    }
+
+    if (2 * pairs->count > world->neighbor_capacity)
+    {
+        world->neighbor_capacity = SDL_max(2 * pairs->count, SDL_max(world->neighbor_capacity * 2, TRON_MIN_PAIR_CAPACITY));
+        world->neighbors = SDL_realloc(world->neighbors, world->neighbor_capacity * sizeof(int));
+    }
+    for (int p = 0; p < pairs->count; p++)
+    {
+        world->neighbors[world->neighbor_cursors[pairs->first[p]]++] = pairs->second[p];
+        world->neighbors[world->neighbor_cursors[pairs->second[p]]++] = pairs->first[p];
+    }
+
+    for (int i = 0; i < num_bikes; i++)
+    {
+        int* list = world->neighbors + offsets[i];
+        int length = offsets[i + 1] - offsets[i];
+        for (int k = 1; k < length; k++)
+        {
+            int bike = list[k];
+            int j = k - 1;
+            while ((j >= 0) && (list[j] > bike))
+            {
+                list[j + 1] = list[j];
+                j--;
+            }
+            list[j + 1] = bike;
+        }
+    }
+}
+
+void TRON_CollideBikes(void* data, int first, int last)
+{
+    TRON_World* world = data;
+
+    for (int i = first; i < last; i++)
+    {
+        world->dying[i] = (!world->dead[i]) && (TRON_CheckBikeCollision(world, i, &world->impacts[i]));
+    }
+}
+
+int TRON_CheckBikesCollisions(TRON_World* world)
+{
+    int deaths = 0;
+    TRON_RunJob(world, TRON_PrepareBikes, world->num_bikes);
+    TRON_SortBikes(world);
+    TRON_FindPairs(world);
+    TRON_BuildNeighbors(world);
+    while ((world->events.count > 0) && (world->events.ticks[0] <= world->tick))
+    {
+        Uint64 tick = world->events.ticks[0];
+        int bike = TRON_PopEvent(&world->events);
+        world->due[bike] = world->due[bike] || (world->predicted_ticks[bike] == tick);
+    }
+    TRON_RunJob(world, TRON_CollideBikes, world->num_bikes);
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        if (world->dying[i])
+        {
+            TRON_StopBikeAtImpact(world, i);
+            TRON_UnlinkRay(world, i);
+            world->dead[i] = true;
+            TRON_UpdateBikeHash(world, i);
+            world->death_ticks[i] = world->tick;
+            deaths++;
+        }
+        else if (!world->dead[i])
+        {
+            world->checked_positions[i] = (SDL_Point){world->x[i], world->y[i]};
+            world->checked_rects[i] = TRON_GetBikeBounds(world, i);
+            world->checked_segments[i] = world->head_segments[i];
+        }
+    }
+    world->num_alive -= deaths;
+    world->checked_tick = world->tick;
+
+    for (int i = 0; i < world->num_bikes; i++)
+    {
+        if (!world->due[i]) { continue; }
+
+        world->due[i] = false;
+        if (!world->dead[i]) { TRON_CastRay(world, i); }
+    }
+
+    return deaths;
+}
+
+int TRON_StepWorld(TRON_World* world)
+{
+    world->tick++;
+    TRON_ApplyTurns(world);
+    TRON_MoveBikes(world);
+    return TRON_CheckBikesCollisions(world);
+}
+
+Uint64 TRON_GetWorldTick(TRON_World* world)
+{
+    return world->tick;
+}
+
+Uint64 TRON_GetWorldHash(TRON_World* world)
+{
+    return world->hash;
+}
+
+int TRON_GetNumBikes(TRON_World* world)
+{
+    return world->num_bikes;
+}
+
+int TRON_CountAliveBikes(TRON_World* world)
+{
+    return world->num_alive;
+}
+
+SDL_FPoint TRON_GetBikePosition(TRON_World* world, int bike)
+{
+    return TRON_GetFloatPoint((SDL_Point){world->x[bike], world->y[bike]});
+}
+
+SDL_FPoint TRON_GetBikePreviousPosition(TRON_World* world, int bike)
+{
+    return TRON_GetFloatPoint(world->previous_positions[bike]);
+}
+
+TRON_Direction TRON_GetBikeDirection(TRON_World* world, int bike)
+{
+    return world->direction[bike];
+}
+
+bool TRON_IsBikeDead(TRON_World* world, int bike)
+{
+    return world->dead[bike];
+}
+
+Uint64 TRON_GetBikeDeathTick(TRON_World* world, int bike)
+{
+    return world->death_ticks[bike];
+}
+
+Sint64 TRON_GetBikeTurnTick(TRON_World* world, int bike)
+{
+    return world->last_turn_ticks[bike];
+}
+
+int TRON_GetBikeHeadSegment(TRON_World* world, int bike)
+{
+    return world->head_segments[bike];
+}
+
+bool TRON_GetBikeImpact(TRON_World* world, int bike, TRON_Impact* impact)
+{
+    if (!world->dead[bike]) { return false; }
+
+    const TRON_Collision* collision = &world->impacts[bike];
+    *impact = (TRON_Impact){collision->time / (float)TRON_TIME_ONE, TRON_GetFloatPoint(collision->point), collision->other};
+    return true;
+}
+
+void TRON_SetWorldThreads(TRON_World* world, int num_threads)
+{
+    JOB_DestroyPool(world->pool);
+    world->pool = NULL;
+    world->num_threads = SDL_max(num_threads, 0);
+}
+
+int TRON_GetWorldThreads(TRON_World* world)
+{
+    return world->num_threads;
+}
+
+void TRON_SetBikeSpeed(TRON_World* world, int bike, float speed)
+{
+    world->speed[bike] = SDL_max(TRON_ToFixed(speed), 0);
+    TRON_UpdateBikeHash(world, bike);
+    TRON_ScheduleBike(world, bike, world->tick + 1);
+}
+
+float TRON_GetBikeSpeed(TRON_World* world, int bike)
+{
+    return world->speed[bike] / (float)TRON_FIXED_ONE;
+}
+
+SDL_FPoint TRON_GetWorldSize(TRON_World* world)
+{
+    return TRON_GetFloatPoint((SDL_Point){world->width, world->height});
+}
+
+TRON_Segments TRON_GetSegments(TRON_World* world)
+{
+    return (TRON_Segments){world->trails.starts, world->trails.ends, world->trails.owners, world->trails.count};
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_rect.h>
+#include <SDL3/SDL_iostream.h>
+
+#define TRON_BIKE_WIDTH 50
+#define TRON_BIKE_HEIGHT 70
+#define TRON_BIKE_SPEED 4.0f
+#define TRON_TRAIL_SIZE 10.0f
+#define TRON_TICK_RATE 60
+#define TRON_TURN_COOLDOWN_TICKS 3
+#define TRON_TURN_FRACTION_STEPS 256
+#define TRON_FIXED_ONE 256
+#define TRON_MAX_WORLD_BIKES 65535
+#define TRON_MIN_TRAIL_CAPACITY 1024
+
+typedef enum TRON_Direction
+{
+    TRON_NORTH,
+    TRON_EAST,
+    TRON_SOUTH,
+    TRON_WEST
+}TRON_Direction;
+
+typedef struct TRON_Segments
+{
+    const SDL_Point* starts;
+    const SDL_Point* ends;
+    const Uint16* owners;
+    int count;
+}TRON_Segments;
+
+typedef struct TRON_Impact
+{
+    float time;
+    SDL_FPoint point;
+    int other;
+}TRON_Impact;
+
+typedef struct TRON_World TRON_World;
+
+typedef struct TRON_Snapshot TRON_Snapshot;
+
+TRON_World* TRON_CreateWorld(float width, float height, int num_bikes);
+
+void TRON_DestroyWorld(TRON_World* world);
+
+void TRON_ResetWorld(TRON_World* world, int num_bikes);
+
+void TRON_SaveWorld(TRON_World* world, SDL_IOStream* stream);
+
+bool TRON_LoadWorld(TRON_World* world, SDL_IOStream* stream);
+
+TRON_World* TRON_CreateWorldMirror(void);
+
+void TRON_MirrorWorld(TRON_World* mirror, TRON_World* world);
+
+TRON_Snapshot* TRON_CreateSnapshot(void);
+
+void TRON_DestroySnapshot(TRON_Snapshot* snapshot);
+
+void TRON_SaveSnapshot(TRON_World* world, TRON_Snapshot* snapshot);
+
+bool TRON_RestoreSnapshot(TRON_World* world, const TRON_Snapshot* snapshot);
+
+int TRON_StepWorld(TRON_World* world);
+
+void TRON_SetWorldThreads(TRON_World* world, int num_threads);
+
+int TRON_GetWorldThreads(TRON_World* world);
+
+bool TRON_TurnBike(TRON_World* world, int bike, TRON_Direction direction);
+
+void TRON_QueueTurn(TRON_World* world, int bike, TRON_Direction direction, int fraction);
+
+void TRON_SetBikeStart(TRON_World* world, int bike, SDL_FPoint position, TRON_Direction direction);
+
+Uint64 TRON_GetWorldTick(TRON_World* world);
+
+Uint64 TRON_GetWorldHash(TRON_World* world);
+
+int TRON_GetNumBikes(TRON_World* world);
+
+int TRON_CountAliveBikes(TRON_World* world);
+
+SDL_FPoint TRON_GetBikePosition(TRON_World* world, int bike);
+
+SDL_FPoint TRON_GetBikePreviousPosition(TRON_World* world, int bike);
+
+TRON_Direction TRON_GetBikeDirection(TRON_World* world, int bike);
+
+bool TRON_IsBikeDead(TRON_World* world, int bike);
+
+Uint64 TRON_GetBikeDeathTick(TRON_World* world, int bike);
+
+bool TRON_GetBikeImpact(TRON_World* world, int bike, TRON_Impact* impact);
+
+void TRON_SetBikeSpeed(TRON_World* world, int bike, float speed);
+
+float TRON_GetBikeSpeed(TRON_World* world, int bike);
+
+Sint64 TRON_GetBikeTurnTick(TRON_World* world, int bike);
+
+int TRON_GetBikeHeadSegment(TRON_World* world, int bike);
+
+SDL_FPoint TRON_GetWorldSize(TRON_World* world);
+
+TRON_Segments TRON_GetSegments(TRON_World* world);
+
+SDL_FPoint TRON_GetFloatPoint(SDL_Point point);
+
+SDL_FRect TRON_GetBikeRectAt(TRON_Direction direction, SDL_FPoint position);
+
+SDL_FRect TRON_GetBikeRect(TRON_World* world, int bike);
@@ -0,0 +1,38 @@
+#include "harness.h"
+
+#define TST_COLLISION_WIDTH 2000.0f
+#define TST_COLLISION_HEIGHT 3200.0f
+#define TST_COLLISION_PATH_Y 1000.0f
+#define TST_COLLISION_CROSSER_SPEED 1.5f
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TRON_World* world = TRON_CreateWorld(TST_COLLISION_WIDTH, TST_COLLISION_HEIGHT, 3);
+    TRON_SetBikeStart(world, 0, (SDL_FPoint){300.0f, TST_COLLISION_PATH_Y}, TRON_EAST);
+    TRON_SetBikeStart(world, 1, (SDL_FPoint){150.0f, 3000.0f}, TRON_NORTH);
+    TRON_SetBikeStart(world, 2, (SDL_FPoint){1000.0f, 2200.0f}, TRON_NORTH);
+    TRON_SetBikeSpeed(world, 2, TST_COLLISION_CROSSER_SPEED);
+
+    bool follower_turned = false;
+    while ((!TRON_IsBikeDead(world, 1)) && (!TRON_IsBikeDead(world, 2)) && (TRON_GetWorldTick(world) < TST_MAX_TICKS))
+    {
+        if ((!follower_turned) && (TRON_GetBikePosition(world, 1).y <= TST_COLLISION_PATH_Y))
+        {
+            follower_turned = TRON_TurnBike(world, 1, TRON_EAST);
+        }
+        TRON_StepWorld(world);
+    }
+
+    TRON_Impact impact = {0};
+    bool ok = TST_Check(follower_turned, "collision", "follower never reached the dead path");
+    ok = ok && TST_Check(TRON_IsBikeDead(world, 0), "collision", "first bike never died");
+    ok = ok && TST_Check(TRON_GetBikeImpact(world, 2, &impact), "collision", "crossing bike outlived the follower");
+    ok = ok && TST_Check(impact.other == 1, "collision", "crossing bike passed through the follower's trail");
+    ok = ok && TST_Check(SDL_fabsf(impact.point.y - TST_COLLISION_PATH_Y) < TRON_BIKE_HEIGHT, "collision", "crossing bike died away from the path");
+
+    TRON_DestroyWorld(world);
+    return ok ? 0 : 1;
+}
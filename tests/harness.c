@@ -0,0 +1,44 @@
+#include "harness.h"
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_properties.h>
+
+void TST_TurnRandomly(TRON_World* world, Uint64* random)
+{
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        if (SDL_rand_r(random, TST_TURN_ODDS) != 0) { continue; }
+
+        TRON_Direction direction = (TRON_Direction)SDL_rand_r(random, 4);
+        int fraction = SDL_rand_r(random, TRON_TURN_FRACTION_STEPS);
+        TRON_QueueTurn(world, i, direction, fraction);
+    }
+}
+
+TRON_World* TST_CopyWorld(TRON_World* world)
+{
+    SDL_FPoint size = TRON_GetWorldSize(world);
+    TRON_World* copy = TRON_CreateWorld(size.x, size.y, TRON_GetNumBikes(world));
+    SDL_IOStream* stream = SDL_IOFromDynamicMem();
+    TRON_SaveWorld(world, stream);
+
+    Sint64 length = SDL_TellIO(stream);
+    const void* data = SDL_GetPointerProperty(SDL_GetIOProperties(stream), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    SDL_IOStream* input = SDL_IOFromConstMem(data, (size_t)length);
+    bool loaded = TRON_LoadWorld(copy, input);
+    SDL_CloseIO(input);
+    SDL_CloseIO(stream);
+
+    if (!loaded)
+    {
+        TRON_DestroyWorld(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+bool TST_Check(bool condition, const char* name, const char* message)
+{
+    if (!condition) { SDL_Log("%s: %s", name, message); }
+    return condition;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "tron.h"
+
+#define TST_TURN_ODDS 40
+#define TST_MAX_TICKS 20000
+
+void TST_TurnRandomly(TRON_World* world, Uint64* random);
+
+TRON_World* TST_CopyWorld(TRON_World* world);
+
+bool TST_Check(bool condition, const char* name, const char* message);
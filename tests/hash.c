@@ -0,0 +1,30 @@
+#include "harness.h"
+
+#define TST_HASH_BIKES 64
+#define TST_HASH_ARENA 4000.0f
+#define TST_HASH_SEED 2
+#define TST_HASH_INTERVAL 25
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TRON_World* world = TRON_CreateWorld(TST_HASH_ARENA, TST_HASH_ARENA, TST_HASH_BIKES);
+    Uint64 random = TST_HASH_SEED;
+    bool ok = true;
+    while ((ok) && (TRON_CountAliveBikes(world) > 1) && (TRON_GetWorldTick(world) < TST_MAX_TICKS))
+    {
+        TST_TurnRandomly(world, &random);
+        TRON_StepWorld(world);
+        if (TRON_GetWorldTick(world) % TST_HASH_INTERVAL != 0) { continue; }
+
+        TRON_World* rehashed = TST_CopyWorld(world);
+        ok = TST_Check(rehashed != NULL, "hash", "world failed to load");
+        ok = ok && TST_Check(TRON_GetWorldHash(rehashed) == TRON_GetWorldHash(world), "hash", "incremental hash differs from full rehash");
+        TRON_DestroyWorld(rehashed);
+    }
+
+    TRON_DestroyWorld(world);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "harness.h"
+
+#define TST_ORACLE_WORLDS 3
+#define TST_ORACLE_CONTACT 1
+
+static const int TST_ORACLE_BIKES[TST_ORACLE_WORLDS] = {16, 64, 20};
+static const float TST_ORACLE_WIDTHS[TST_ORACLE_WORLDS] = {3000.0f, 4000.0f, 1920.0f};
+static const float TST_ORACLE_HEIGHTS[TST_ORACLE_WORLDS] = {3000.0f, 4000.0f, 1080.0f};
+static const Uint64 TST_ORACLE_SEEDS[TST_ORACLE_WORLDS] = {18, 5, 6};
+
+SDL_Rect TST_GetFixedRect(SDL_FRect rect)
+{
+    return (SDL_Rect){(int)SDL_roundf(rect.x * TRON_FIXED_ONE), (int)SDL_roundf(rect.y * TRON_FIXED_ONE),
+                      (int)SDL_roundf(rect.w * TRON_FIXED_ONE), (int)SDL_roundf(rect.h * TRON_FIXED_ONE)};
+}
+
+SDL_Rect TST_GetTrailRect(const TRON_Segments* segments, int segment)
+{
+    SDL_Point p1 = segments->starts[segment];
+    SDL_Point p2 = segments->ends[segment];
+    int size = (int)(TRON_TRAIL_SIZE * TRON_FIXED_ONE);
+
+    if (p1.x == p2.x) { return (SDL_Rect){p1.x - size / 2, SDL_min(p1.y, p2.y), size, SDL_abs(p2.y - p1.y)}; }
+    return (SDL_Rect){SDL_min(p1.x, p2.x), p1.y - size / 2, SDL_abs(p2.x - p1.x), size};
+}
+
+bool TST_Touches(const SDL_Rect* a, const SDL_Rect* b)
+{
+    return (a->x <= b->x + b->w + TST_ORACLE_CONTACT) && (b->x <= a->x + a->w + TST_ORACLE_CONTACT) &&
+           (a->y <= b->y + b->h + TST_ORACLE_CONTACT) && (b->y <= a->y + a->h + TST_ORACLE_CONTACT);
+}
+
+int TST_GetPreviousSegment(const TRON_Segments* segments, int bike, int head)
+{
+    for (int k = head - 1; k >= 0; k--)
+    {
+        if (segments->owners[k] == bike) { return k; }
+    }
+    return -1;
+}
+
+bool TST_HitsTrail(TRON_World* world, int bike)
+{
+    TRON_Segments segments = TRON_GetSegments(world);
+    SDL_Rect rect = TST_GetFixedRect(TRON_GetBikeRect(world, bike));
+    int head = TRON_GetBikeHeadSegment(world, bike);
+    int previous = TST_GetPreviousSegment(&segments, bike, head);
+
+    for (int k = 0; k < segments.count; k++)
+    {
+        if ((TRON_IsBikeDead(world, segments.owners[k])) || (k == head) || (k == previous)) { continue; }
+
+        SDL_Rect trail = TST_GetTrailRect(&segments, k);
+        if (SDL_HasRectIntersection(&rect, &trail)) { return true; }
+    }
+    return false;
+}
+
+bool TST_HitsOpposingBike(TRON_World* world, int bike)
+{
+    SDL_Rect rect = TST_GetFixedRect(TRON_GetBikeRect(world, bike));
+    TRON_Direction direction = TRON_GetBikeDirection(world, bike);
+
+    for (int i = 0; i < TRON_GetNumBikes(world); i++)
+    {
+        if ((TRON_IsBikeDead(world, i)) || (TRON_GetBikeDirection(world, i) != (direction + 2) % 4)) { continue; }
+
+        SDL_Rect other = TST_GetFixedRect(TRON_GetBikeRect(world, i));
+        if (SDL_HasRectIntersection(&rect, &other)) { return true; }
+    }
+    return false;
+}
+
+bool TST_HasContact(TRON_World* world, int bike)
+{
+    TRON_Impact impact;
+    SDL_Rect rect = TST_GetFixedRect(TRON_GetBikeRect(world, bike));
+    if (!TRON_GetBikeImpact(world, bike, &impact)) { return false; }
+
+    if (impact.other < 0)
+    {
+        SDL_Rect arena = TST_GetFixedRect((SDL_FRect){0.0f, 0.0f, TRON_GetWorldSize(world).x, TRON_GetWorldSize(world).y});
+        return (rect.x <= 0) || (rect.y <= 0) || (rect.x + rect.w >= arena.w) || (rect.y + rect.h >= arena.h);
+    }
+
+    TRON_Segments segments = TRON_GetSegments(world);
+    SDL_Rect other = TST_GetFixedRect(TRON_GetBikeRect(world, impact.other));
+    if (TST_Touches(&rect, &other)) { return true; }
+    for (int k = 0; k < segments.count; k++)
+    {
+        SDL_Rect trail = TST_GetTrailRect(&segments, k);
+        if ((segments.owners[k] == impact.other) && (TST_Touches(&rect, &trail))) { return true; }
+    }
+    return false;
+}
+
+bool TST_RunOracle(int num_bikes, float width, float height, Uint64 seed)
+{
+    TRON_World* world = TRON_CreateWorld(width, height, num_bikes);
+    bool* dead = SDL_calloc(num_bikes, sizeof(bool));
+    Uint64 random = seed;
+    bool ok = true;
+
+    while ((ok) && (TRON_CountAliveBikes(world) > 1) && (TRON_GetWorldTick(world) < TST_MAX_TICKS))
+    {
+        TST_TurnRandomly(world, &random);
+        TRON_StepWorld(world);
+        for (int i = 0; (ok) && (i < num_bikes); i++)
+        {
+            if (!TRON_IsBikeDead(world, i))
+            {
+                ok = TST_Check(!TST_HitsTrail(world, i), "oracle", "live bike overlaps a live trail");
+                ok = ok && TST_Check(!TST_HitsOpposingBike(world, i), "oracle", "live bike overlaps an opposing bike");
+            }
+            else if (!dead[i])
+            {
+                dead[i] = true;
+                ok = TST_Check(TST_HasContact(world, i), "oracle", "bike died without touching what it hit");
+            }
+        }
+    }
+
+    SDL_free(dead);
+    TRON_DestroyWorld(world);
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    bool ok = true;
+    for (int i = 0; (ok) && (i < TST_ORACLE_WORLDS); i++)
+    {
+        ok = TST_RunOracle(TST_ORACLE_BIKES[i], TST_ORACLE_WIDTHS[i], TST_ORACLE_HEIGHTS[i], TST_ORACLE_SEEDS[i]);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "harness.h"
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_properties.h>
+
+#define TST_SAVELOAD_BIKES 20
+#define TST_SAVELOAD_WIDTH 1920.0f
+#define TST_SAVELOAD_HEIGHT 1080.0f
+#define TST_SAVELOAD_SEED 4
+#define TST_SAVELOAD_TICKS 150
+
+bool TST_SaveEqually(TRON_World* world, TRON_World* copy)
+{
+    SDL_IOStream* first = SDL_IOFromDynamicMem();
+    SDL_IOStream* second = SDL_IOFromDynamicMem();
+    TRON_SaveWorld(world, first);
+    TRON_SaveWorld(copy, second);
+
+    Sint64 length = SDL_TellIO(first);
+    const void* first_data = SDL_GetPointerProperty(SDL_GetIOProperties(first), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    const void* second_data = SDL_GetPointerProperty(SDL_GetIOProperties(second), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    bool equal = (length == SDL_TellIO(second)) && (SDL_memcmp(first_data, second_data, (size_t)length) == 0);
+    SDL_CloseIO(first);
+    SDL_CloseIO(second);
+    return equal;
+}
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TRON_World* world = TRON_CreateWorld(TST_SAVELOAD_WIDTH, TST_SAVELOAD_HEIGHT, TST_SAVELOAD_BIKES);
+    Uint64 random = TST_SAVELOAD_SEED;
+    for (int tick = 0; tick < TST_SAVELOAD_TICKS; tick++)
+    {
+        TST_TurnRandomly(world, &random);
+        TRON_StepWorld(world);
+    }
+
+    TRON_World* copy = TST_CopyWorld(world);
+    bool ok = TST_Check(copy != NULL, "saveload", "world failed to load");
+    ok = ok && TST_Check(TRON_GetWorldHash(copy) == TRON_GetWorldHash(world), "saveload", "loaded hash differs");
+    ok = ok && TST_Check(TST_SaveEqually(world, copy), "saveload", "saving the loaded world gives different bytes");
+
+    Uint64 copy_random = random;
+    while ((ok) && (TRON_CountAliveBikes(world) > 1) && (TRON_GetWorldTick(world) < TST_MAX_TICKS))
+    {
+        TST_TurnRandomly(world, &random);
+        TST_TurnRandomly(copy, &copy_random);
+        TRON_StepWorld(world);
+        TRON_StepWorld(copy);
+        ok = TST_Check(TRON_GetWorldHash(copy) == TRON_GetWorldHash(world), "saveload", "loaded world diverged");
+    }
+
+    SDL_IOStream* truncated = SDL_IOFromConstMem("\x14\x00\x00\x00", 4);
+    ok = ok && TST_Check(!TRON_LoadWorld(copy, truncated), "saveload", "truncated world loaded");
+    SDL_CloseIO(truncated);
+
+    TRON_DestroyWorld(copy);
+    TRON_DestroyWorld(world);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "harness.h"
+
+#define TST_SNAPSHOT_BIKES 32
+#define TST_SNAPSHOT_ARENA 3000.0f
+#define TST_SNAPSHOT_SEED 3
+#define TST_SNAPSHOT_TICKS 400
+#define TST_SNAPSHOT_RING 8
+#define TST_SNAPSHOT_INTERVAL 7
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TRON_World* world = TRON_CreateWorld(TST_SNAPSHOT_ARENA, TST_SNAPSHOT_ARENA, TST_SNAPSHOT_BIKES);
+    TRON_Snapshot* snapshots[TST_SNAPSHOT_RING];
+    Uint64 randoms[TST_SNAPSHOT_RING];
+    for (int i = 0; i < TST_SNAPSHOT_RING; i++) { snapshots[i] = TRON_CreateSnapshot(); }
+
+    Uint64* hashes = SDL_malloc((TST_SNAPSHOT_TICKS + 1) * sizeof(Uint64));
+    Uint64 random = TST_SNAPSHOT_SEED;
+    hashes[0] = TRON_GetWorldHash(world);
+    for (int tick = 0; tick < TST_SNAPSHOT_TICKS; tick++)
+    {
+        TST_TurnRandomly(world, &random);
+        TRON_StepWorld(world);
+        hashes[tick + 1] = TRON_GetWorldHash(world);
+    }
+
+    TRON_World* replay = TRON_CreateWorld(TST_SNAPSHOT_ARENA, TST_SNAPSHOT_ARENA, TST_SNAPSHOT_BIKES);
+    random = TST_SNAPSHOT_SEED;
+    bool ok = true;
+    for (int tick = 0; (ok) && (tick < TST_SNAPSHOT_TICKS); tick++)
+    {
+        int slot = tick % TST_SNAPSHOT_RING;
+        TRON_SaveSnapshot(replay, snapshots[slot]);
+        randoms[slot] = random;
+        TST_TurnRandomly(replay, &random);
+        TRON_StepWorld(replay);
+        if ((tick % TST_SNAPSHOT_INTERVAL != 0) || (tick < TST_SNAPSHOT_RING)) { continue; }
+
+        int rewind = 1 + tick % (TST_SNAPSHOT_RING - 1);
+        int from = tick + 1 - rewind;
+        ok = TST_Check(TRON_RestoreSnapshot(replay, snapshots[from % TST_SNAPSHOT_RING]), "snapshot", "snapshot failed to restore");
+        ok = ok && TST_Check(TRON_GetWorldHash(replay) == hashes[from], "snapshot", "restored hash differs");
+
+        random = randoms[from % TST_SNAPSHOT_RING];
+        for (int t = from; (ok) && (t <= tick); t++)
+        {
+            TRON_SaveSnapshot(replay, snapshots[t % TST_SNAPSHOT_RING]);
+            randoms[t % TST_SNAPSHOT_RING] = random;
+            TST_TurnRandomly(replay, &random);
+            TRON_StepWorld(replay);
+            ok = TST_Check(TRON_GetWorldHash(replay) == hashes[t + 1], "snapshot", "resimulated hash differs");
+        }
+    }
+
+    for (int i = 0; i < TST_SNAPSHOT_RING; i++) { TRON_DestroySnapshot(snapshots[i]); }
+    SDL_free(hashes);
+    TRON_DestroyWorld(replay);
+    TRON_DestroyWorld(world);
+    return ok ? 0 : 1;
+}
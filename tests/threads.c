@@ -0,0 +1,33 @@
+#include "harness.h"
+
+#define TST_THREADS_BIKES 1000
+#define TST_THREADS_ARENA 20000.0f
+#define TST_THREADS_SEED 1
+
+int main(int argc, char* argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    TRON_World* single = TRON_CreateWorld(TST_THREADS_ARENA, TST_THREADS_ARENA, TST_THREADS_BIKES);
+    TRON_World* threaded = TRON_CreateWorld(TST_THREADS_ARENA, TST_THREADS_ARENA, TST_THREADS_BIKES);
+    TRON_SetWorldThreads(single, 1);
+    TRON_SetWorldThreads(threaded, 4);
+
+    Uint64 single_random = TST_THREADS_SEED;
+    Uint64 threaded_random = TST_THREADS_SEED;
+    bool ok = true;
+    while ((ok) && (TRON_CountAliveBikes(single) > 1) && (TRON_GetWorldTick(single) < TST_MAX_TICKS))
+    {
+        TST_TurnRandomly(single, &single_random);
+        TST_TurnRandomly(threaded, &threaded_random);
+        TRON_StepWorld(single);
+        TRON_StepWorld(threaded);
+        ok = TST_Check(TRON_GetWorldHash(single) == TRON_GetWorldHash(threaded), "threads", "hash differs between 1 and 4 threads");
+    }
+    ok = ok && TST_Check(TRON_CountAliveBikes(single) == TRON_CountAliveBikes(threaded), "threads", "alive count differs");
+
+    TRON_DestroyWorld(single);
+    TRON_DestroyWorld(threaded);
+    return ok ? 0 : 1;
+}